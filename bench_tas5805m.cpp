@@ -0,0 +1,353 @@
+/**
+ * Host Microbenchmarks for TAS5805M Coefficient Design, Packing and Apply
+ *
+ * Complements test_tas5805m.cpp (correctness) with timing and I2C cost
+ * numbers, so regressions show up on the host before they reach boot time.
+ * The real firmware headers are compiled against the mocks in host_mock/:
+ * I2C transfers are counted instead of sent and delay() is accumulated
+ * instead of slept.
+ *
+ * Build and run:
+ *   g++ -std=c++17 -O2 -Ihost_mock -o bench_tas5805m bench_tas5805m.cpp -lm && ./bench_tas5805m
+ *
+ * Timings are host ns/op and only meaningful relative to each other; the I2C
+ * numbers (transactions, bytes, sleeps) are exact for the device, and
+ * "model ms" adds 400 kHz bus time to the sleeps.
+ */
+
+#include "tas5805m_profile_manager.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+
+using namespace tas5805m_biquad;
+using tas5805m_profile::CalibrationProfile;
+
+static constexpr uint8_t BENCH_ADDRESS = 0x2C;
+
+// Results are folded into this so the optimizer can't drop the work
+static volatile uint32_t g_sink = 0;
+
+// =============================================================================
+// TIMING HELPERS
+// =============================================================================
+
+/**
+ * Run fn() iterations times and print the average cost per call
+ */
+template<typename Fn>
+static void bench(const char* name, uint32_t iterations, Fn fn) {
+    // Warm caches (including the trig cache) before timing
+    for (uint32_t i = 0; i < iterations / 10 + 1; i++) fn(i);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) fn(i);
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("  %-40s %10.1f ns/op\n", name, ns / iterations);
+}
+
+/**
+ * Representative 30-biquad room correction: a few cuts per channel, the rest bypass
+ */
+static CalibrationProfile make_bench_profile() {
+    CalibrationProfile profile;
+    strncpy(profile.name, "Bench", sizeof(profile.name) - 1);
+
+    // Designed as the filter services do, so storage and rate changes take the design path
+    using tas5805m_profile::add_filter_to_profile;
+    add_filter_to_profile(profile, 0, 0, FilterDesign(FilterType::HIGHPASS, 25.0f, 0.0f, 0.7071f));
+    add_filter_to_profile(profile, 0, 1, FilterDesign(FilterType::PEAKING, 48.0f, -6.0f, 4.0f));
+    add_filter_to_profile(profile, 0, 2, FilterDesign(FilterType::PEAKING, 95.0f, -4.5f, 3.0f));
+    add_filter_to_profile(profile, 0, 3, FilterDesign(FilterType::LOW_SHELF, 120.0f, 2.0f, 1.0f));
+    add_filter_to_profile(profile, 0, 4, FilterDesign(FilterType::PEAKING, 210.0f, -3.0f, 2.0f));
+    add_filter_to_profile(profile, 0, 5, FilterDesign(FilterType::NOTCH, 1000.0f, 0.0f, 8.0f));
+    add_filter_to_profile(profile, 0, 6, FilterDesign(FilterType::HIGH_SHELF, 8000.0f, -2.0f, 1.0f));
+
+    add_filter_to_profile(profile, 1, 0, FilterDesign(FilterType::HIGHPASS, 25.0f, 0.0f, 0.7071f));
+    add_filter_to_profile(profile, 1, 1, FilterDesign(FilterType::PEAKING, 52.0f, -5.0f, 4.0f));
+    add_filter_to_profile(profile, 1, 2, FilterDesign(FilterType::PEAKING, 102.0f, -3.5f, 3.0f));
+    add_filter_to_profile(profile, 1, 3, FilterDesign(FilterType::LOW_SHELF, 120.0f, 2.0f, 1.0f));
+    add_filter_to_profile(profile, 1, 4, FilterDesign(FilterType::LOWPASS, 18000.0f, 0.0f, 0.7071f));
+
+    profile.count_active_filters();
+    profile.update_checksum();
+    return profile;
+}
+
+// =============================================================================
+// CPU BENCHMARKS
+// =============================================================================
+
+static void bench_designers() {
+    printf("\nFilter designers (runtime, fs=48 kHz):\n");
+
+    // Sweep the frequency so the trig cache sees both hits and misses
+    auto freq = [](uint32_t i) { return 20.0f + static_cast<float>(i % 1000) * 19.0f; };
+
+    bench("calc_parametric_eq", 200000, [&](uint32_t i) {
+        g_sink += static_cast<uint32_t>(calc_parametric_eq(freq(i), -3.0f, 2.0f).b1 * 1000.0f);
+    });
+    bench("calc_low_shelf", 200000, [&](uint32_t i) {
+        g_sink += static_cast<uint32_t>(calc_low_shelf(freq(i), 3.0f).b1 * 1000.0f);
+    });
+    bench("calc_high_shelf", 200000, [&](uint32_t i) {
+        g_sink += static_cast<uint32_t>(calc_high_shelf(freq(i), -3.0f).b1 * 1000.0f);
+    });
+    bench("calc_highpass", 200000, [&](uint32_t i) {
+        g_sink += static_cast<uint32_t>(calc_highpass(freq(i), 0.7071f).b1 * 1000.0f);
+    });
+    bench("calc_lowpass", 200000, [&](uint32_t i) {
+        g_sink += static_cast<uint32_t>(calc_lowpass(freq(i), 0.7071f).b1 * 1000.0f);
+    });
+    bench("calc_notch", 200000, [&](uint32_t i) {
+        g_sink += static_cast<uint32_t>(calc_notch(freq(i), 5.0f).b1 * 1000.0f);
+    });
+    bench("calc_parametric_eq (graphic EQ centre)", 200000, [&](uint32_t i) {
+        float f = GRAPHIC_EQ_CENTRES_HZ[i % BIQUADS_PER_CHANNEL];
+        g_sink += static_cast<uint32_t>(calc_parametric_eq(f, 2.0f, 1.4f).b1 * 1000.0f);
+    });
+}
+
+static void bench_cascade(const CalibrationProfile& profile) {
+    printf("\nCascade optimizer (per channel):\n");
+
+    // Dense measurement-style fit: 15 overlapping PEQs
+    BiquadCoeffs dense[15];
+    for (int k = 0; k < 15; k++) {
+        float f = 40.0f * std::pow(1.35f, static_cast<float>(k));
+        dense[k] = calc_parametric_eq(f, (k % 3 == 0) ? -2.0f : -0.8f, 2.5f);
+    }
+
+    bench("optimize_channel (15 overlapping PEQs)", 50, [&](uint32_t) {
+        BiquadCoeffs ch[15];
+        memcpy(ch, dense, sizeof(ch));
+        g_sink += tas5805m_cascade::optimize_channel(ch, tas5805m_cascade::CascadeOptions());
+    });
+
+    bench("optimize_channel (bench profile, left)", 200, [&](uint32_t) {
+        BiquadCoeffs ch[15];
+        for (int i = 0; i < 15; i++) ch[i] = profile.left_channel[i].to_coeffs();
+        g_sink += tas5805m_cascade::optimize_channel(ch, tas5805m_cascade::CascadeOptions());
+    });
+}
+
+static void bench_packing(const CalibrationProfile& profile) {
+    printf("\nPacking (per 30-biquad profile, 150 coefficients):\n");
+
+    bench("float_to_9_23 x150", 20000, [&](uint32_t) {
+        uint32_t acc = 0;
+        for (int i = 0; i < 15; i++) {
+            const auto& l = profile.left_channel[i];
+            const auto& r = profile.right_channel[i];
+            acc += float_to_9_23(l.b0) + float_to_9_23(l.b1) + float_to_9_23(l.b2) +
+                   float_to_9_23(l.a1) + float_to_9_23(l.a2);
+            acc += float_to_9_23(r.b0) + float_to_9_23(r.b1) + float_to_9_23(r.b2) +
+                   float_to_9_23(r.a1) + float_to_9_23(r.a2);
+        }
+        g_sink += acc;
+    });
+
+    int32_t fixed[150];
+    for (int i = 0; i < 150; i++) fixed[i] = float_to_9_23(0.001f * i - 0.07f);
+    bench("pack_be32 x150", 20000, [&](uint32_t) {
+        uint8_t out[600];
+        for (int i = 0; i < 150; i++) pack_be32(fixed[i], &out[i * 4]);
+        g_sink += out[599];
+    });
+
+    bench("pack_biquad x30", 20000, [&](uint32_t) {
+        uint8_t out[20];
+        for (int i = 0; i < 15; i++) {
+            pack_biquad(profile.left_channel[i].to_coeffs(), out);
+            g_sink += out[19];
+            pack_biquad(profile.right_channel[i].to_coeffs(), out);
+            g_sink += out[19];
+        }
+    });
+}
+
+static void bench_storage(const CalibrationProfile& profile) {
+    printf("\nProfile storage:\n");
+
+    bench("CalibrationProfile::calculate_checksum", 20000, [&](uint32_t) {
+        g_sink += profile.calculate_checksum();
+    });
+
+    tas5805m_profile::CompactProfileHeader header;
+    uint8_t payload[tas5805m_profile::COMPACT_PAYLOAD_MAX];
+    size_t payload_bytes = 0;
+    bench("compact_encode (profile->record)", 20000, [&](uint32_t) {
+        payload_bytes = tas5805m_profile::compact_encode(profile, header, payload);
+        g_sink += header.stored;
+    });
+
+    bench("compact_expand_wire (record->wire)", 20000, [&](uint32_t) {
+        uint8_t wire[2][tas5805m_profile::IMAGE_CHANNEL_BYTES];
+        tas5805m_profile::compact_expand_wire(header, payload, wire);
+        g_sink += wire[1][19];
+    });
+
+    bench("compact_expand_wire (at 44.1 kHz)", 20000, [&](uint32_t) {
+        uint8_t wire[2][tas5805m_profile::IMAGE_CHANNEL_BYTES];
+        tas5805m_profile::compact_expand_wire(header, payload, wire, 44100.0f);
+        g_sink += wire[1][19];
+    });
+
+    bench("compact_decode (record->profile)", 20000, [&](uint32_t) {
+        CalibrationProfile decoded;
+        tas5805m_profile::compact_decode(header, payload, decoded);
+        g_sink += decoded.checksum;
+    });
+
+    // Alternating rates defeat the cache; one rate hits after the first call
+    tas5805m_profile::RateImageCache cache;
+    bench("RateImageCache::image_for (miss)", 20000, [&](uint32_t i) {
+        cache.clear();
+        g_sink += cache.image_for(profile, (i & 1) ? 44100.0f : 96000.0f)[0][19];
+    });
+
+    bench("RateImageCache::image_for (hit)", 20000, [&](uint32_t) {
+        g_sink += cache.image_for(profile, 44100.0f)[0][19];
+    });
+
+    size_t capacity = tas5805m_profile::COMPACT_CAPACITIES[tas5805m_profile::compact_format_for(payload_bytes) - 1];
+    printf("  NVS bytes: compact record %zu (%u biquads in %zu bytes), legacy profile + image %zu\n",
+           sizeof(tas5805m_profile::CompactProfileHeader) + capacity * BIQUAD_WIRE_BYTES + sizeof(uint32_t),
+           (unsigned)header.stored, payload_bytes,
+           sizeof(tas5805m_profile::LegacyCalibrationProfile) + 612);  // 612: old ProfileImage
+}
+
+// =============================================================================
+// I2C COST OF EACH APPLY PATH
+// =============================================================================
+
+/**
+ * Run one apply path from a cold DSP shadow and print its bus cost
+ *
+ * @param warm Keep the shadow from the previous path (measures a re-apply)
+ */
+template<typename Fn>
+static void measure_apply(const char* name, esphome::i2c::I2CBus& bus, bool warm, Fn fn) {
+    if (!warm) invalidate_coeff_shadow();
+    invalidate_register_cursor();
+    bus.reset_counters();
+
+    bool ok = fn();
+
+    printf("  %-40s %6u %8llu %8.1f %8.1f%s\n", name, bus.transactions(),
+           static_cast<unsigned long long>(bus.bytes), bus.sleep_ms(), bus.modeled_ms(),
+           ok ? "" : "  FAILED");
+}
+
+static void bench_apply_paths(const CalibrationProfile& profile) {
+    printf("\nApply paths (30 biquads):\n");
+    printf("  %-40s %6s %8s %8s %8s\n", "", "xfers", "bytes", "sleep ms", "model ms");
+
+    esphome::i2c::I2CBus bus;
+    BiquadCoeffs left[15], right[15];
+    for (int i = 0; i < 15; i++) {
+        left[i] = profile.left_channel[i].to_coeffs();
+        right[i] = profile.right_channel[i].to_coeffs();
+    }
+    tas5805m_profile::CompactProfileHeader header;
+    uint8_t payload[tas5805m_profile::COMPACT_PAYLOAD_MAX];
+    uint8_t wire[2][tas5805m_profile::IMAGE_CHANNEL_BYTES];
+    tas5805m_profile::compact_encode(profile, header, payload);
+    tas5805m_profile::compact_expand_wire(header, payload, wire);
+
+    measure_apply("write_biquad x30", bus, false, [&] {
+        bool ok = true;
+        for (int i = 0; i < 15; i++) {
+            ok = write_biquad(&bus, BENCH_ADDRESS, 0, i, left[i].b0, left[i].b1, left[i].b2,
+                              left[i].a1, left[i].a2) && ok;
+            ok = write_biquad(&bus, BENCH_ADDRESS, 1, i, right[i].b0, right[i].b1, right[i].b2,
+                              right[i].a1, right[i].a2) && ok;
+        }
+        return ok;
+    });
+
+    measure_apply("write_biquad x15 (channel 2)", bus, false, [&] {
+        bool ok = true;
+        for (int i = 0; i < 15; i++) {
+            ok = write_biquad(&bus, BENCH_ADDRESS, 2, i, left[i].b0, left[i].b1, left[i].b2,
+                              left[i].a1, left[i].a2) && ok;
+        }
+        return ok;
+    });
+
+    measure_apply("write_biquads_page x8", bus, false, [&] {
+        TAS5805M_I2C dev(&bus, BENCH_ADDRESS);
+        bool ok = true;
+        for (int p = 0; p < 4; p++) {
+            size_t count = (p == 3) ? 3 : 4;
+            ok = write_biquads_page(dev, PAGE_LEFT_BQ[p * 4], &left[p * 4], count) && ok;
+            ok = write_biquads_page(dev, PAGE_RIGHT_BQ[p * 4], &right[p * 4], count) && ok;
+        }
+        return dev.return_to_normal() && ok;
+    });
+
+    measure_apply("write_all_biquads_batched", bus, false, [&] {
+        return write_all_biquads_batched(&bus, BENCH_ADDRESS, left, right);
+    });
+
+    measure_apply("write_all_biquads_delta (cold)", bus, false, [&] {
+        return write_all_biquads_delta(&bus, BENCH_ADDRESS, left, right);
+    });
+
+    measure_apply("write_all_biquads_delta (re-apply)", bus, true, [&] {
+        return write_all_biquads_delta(&bus, BENCH_ADDRESS, left, right);
+    });
+
+    measure_apply("write_all_biquads_wire (boot record)", bus, false, [&] {
+        return write_all_biquads_wire(&bus, BENCH_ADDRESS, wire);
+    });
+
+    measure_apply("write_all_biquads_linked", bus, false, [&] {
+        return write_all_biquads_linked(&bus, BENCH_ADDRESS, left);
+    });
+
+    measure_apply("write_all_biquads_atomic (cold)", bus, false, [&] {
+        return write_all_biquads_atomic(&bus, BENCH_ADDRESS, left, right);
+    });
+
+    // One slider move on an otherwise up-to-date DSP
+    left[2] = calc_parametric_eq(97.0f, -4.5f, 3.0f);
+    measure_apply("write_all_biquads_atomic (1 changed)", bus, true, [&] {
+        return write_all_biquads_atomic(&bus, BENCH_ADDRESS, left, right);
+    });
+
+    measure_apply("verify_coeff_shadow (clean)", bus, true, [&] {
+        return verify_coeff_shadow(&bus, BENCH_ADDRESS);
+    });
+
+    // Brown-out lost one biquad
+    bus.poke(BOOK_COEFF, biquad_page(1, 3), OFFSET_BQ[3], 0x7E);
+    measure_apply("verify_coeff_shadow (1 repaired)", bus, true, [&] {
+        return verify_coeff_shadow(&bus, BENCH_ADDRESS);
+    });
+
+    measure_apply("read_all_biquads_wire", bus, true, [&] {
+        uint8_t wire[2][BIQUADS_PER_CHANNEL * BIQUAD_WIRE_BYTES];
+        return read_all_biquads_wire(&bus, BENCH_ADDRESS, wire);
+    });
+}
+
+int main() {
+    printf("TAS5805M host benchmarks\n");
+    printf("========================\n");
+
+    CalibrationProfile profile = make_bench_profile();
+
+    bench_designers();
+    bench_packing(profile);
+    bench_cascade(profile);
+    bench_storage(profile);
+    bench_apply_paths(profile);
+
+    printf("\n(sink %u)\n", static_cast<unsigned>(g_sink));
+    return 0;
+}
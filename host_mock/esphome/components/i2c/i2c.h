@@ -0,0 +1,184 @@
+/**
+ * Host mock: ESPHome I2C bus
+ *
+ * Records every transaction and emulates the TAS5805M register map
+ * (book/page select, auto-increment writes, register-pointer reads), so the
+ * firmware headers can be exercised without hardware.
+ *
+ * Timing model: each transaction costs start + stop + 9 bits per byte
+ * (address, register and payload) at 400 kHz. modeled_ms() adds the
+ * delay() sleeps issued since the last reset_counters(), which gives the
+ * wall time an apply path would take on the device, retries included.
+ */
+
+#pragma once
+
+#include "esphome/core/hal.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace esphome {
+namespace i2c {
+
+enum ErrorCode {
+    ERROR_OK = 0,
+    ERROR_INVALID_ARGUMENT = 1,
+    ERROR_NOT_ACKNOWLEDGED = 2,
+    ERROR_TIMEOUT = 3,
+};
+
+class I2CBus {
+public:
+    static constexpr uint32_t BUS_HZ = 400000;
+
+    /**
+     * One recorded transfer
+     */
+    struct Transaction {
+        uint8_t address;
+        bool read;
+        bool stop;
+        std::vector<uint8_t> data;   // Written bytes (incl. register), or bytes read back
+        ErrorCode result;
+        uint8_t book;                // Chip book/page the transfer addressed
+        uint8_t page;
+    };
+
+    std::vector<Transaction> log;
+
+    uint32_t write_count = 0;   // Write transactions (incl. register-pointer writes for reads)
+    uint32_t read_count = 0;    // Read transactions
+    uint64_t bytes = 0;         // Payload bytes on the wire, excluding address bytes
+    uint64_t bus_bits = 0;      // Modeled bit times on the wire
+
+    // Fault injection: the next fail_next transactions are NACKed
+    int fail_next = 0;
+
+    // Another bus user: called after every successful write, e.g. to poke
+    // a register the way the tas5805m driver would between two transfers
+    std::function<void(I2CBus&, const Transaction&)> on_write;
+
+    ErrorCode write(uint8_t address, const uint8_t* data, size_t len, bool stop = true) {
+        write_count++;
+        if (fail_next > 0) {
+            fail_next--;
+            record(address, false, stop, data, 0, ERROR_NOT_ACKNOWLEDGED);
+            return ERROR_NOT_ACKNOWLEDGED;
+        }
+
+        record(address, false, stop, data, len, ERROR_OK);
+        bytes += len;
+        apply_write(data, len);
+        if (on_write) on_write(*this, log.back());
+        return ERROR_OK;
+    }
+
+    ErrorCode read(uint8_t address, uint8_t* data, size_t len) {
+        read_count++;
+        if (fail_next > 0) {
+            fail_next--;
+            record(address, true, true, nullptr, 0, ERROR_NOT_ACKNOWLEDGED);
+            return ERROR_NOT_ACKNOWLEDGED;
+        }
+
+        for (size_t i = 0; i < len; i++) {
+            data[i] = peek(book_, page_, static_cast<uint8_t>(pointer_ + i));
+        }
+        record(address, true, true, data, len, ERROR_OK);
+        bytes += len;
+        return ERROR_OK;
+    }
+
+    uint32_t transactions() const { return write_count + read_count; }
+
+    /**
+     * Modeled wall time since the last reset_counters(): bus time plus sleeps
+     */
+    double modeled_ms() const {
+        return bus_bits * 1000.0 / BUS_HZ + sleep_ms();
+    }
+
+    /**
+     * delay()/delayMicroseconds() time since the last reset_counters()
+     */
+    double sleep_ms() const {
+        return (host_mock::g_sleep_us - sleep_at_reset_) / 1000.0;
+    }
+
+    /**
+     * Start a new measurement window (the emulated registers are kept)
+     */
+    void reset_counters() {
+        log.clear();
+        write_count = 0;
+        read_count = 0;
+        bytes = 0;
+        bus_bits = 0;
+        sleep_at_reset_ = host_mock::g_sleep_us;
+    }
+
+    // Emulated register access, bypassing the bus
+    uint8_t peek(uint8_t book, uint8_t page, uint8_t reg) const {
+        auto it = regs_.find(key(book, page, reg));
+        return it == regs_.end() ? 0 : it->second;
+    }
+
+    void poke(uint8_t book, uint8_t page, uint8_t reg, uint8_t value) {
+        regs_[key(book, page, reg)] = value;
+    }
+
+    uint8_t book() const { return book_; }
+    uint8_t page() const { return page_; }
+
+private:
+    std::map<uint32_t, uint8_t> regs_;
+    uint8_t book_ = 0;
+    uint8_t page_ = 0;
+    uint8_t pointer_ = 0;
+    uint64_t sleep_at_reset_ = 0;
+
+    static uint32_t key(uint8_t book, uint8_t page, uint8_t reg) {
+        return (static_cast<uint32_t>(book) << 16) | (static_cast<uint32_t>(page) << 8) | reg;
+    }
+
+    void record(uint8_t address, bool read, bool stop, const uint8_t* data, size_t len,
+                ErrorCode result) {
+        // Start + address byte (+ payload bytes) + stop/repeated start
+        bus_bits += 2 + 9 * (1 + len);
+
+        Transaction t;
+        t.address = address;
+        t.read = read;
+        t.stop = stop;
+        if (data != nullptr) t.data.assign(data, data + len);
+        t.result = result;
+        t.book = book_;
+        t.page = page_;
+        log.push_back(t);
+    }
+
+    // Register 0x00 selects the page, 0x7F on page 0 selects the book; all
+    // other registers auto-increment from the first byte
+    void apply_write(const uint8_t* data, size_t len) {
+        if (len == 0) return;
+        pointer_ = data[0];
+        if (len == 1) return;  // Register pointer for a following read
+
+        for (size_t i = 1; i < len; i++) {
+            uint8_t reg = static_cast<uint8_t>(pointer_ + i - 1);
+            if (reg == 0x00) {
+                page_ = data[i];
+            } else if (reg == 0x7F && page_ == 0) {
+                book_ = data[i];
+            } else {
+                poke(book_, page_, reg, data[i]);
+            }
+        }
+    }
+};
+
+}  // namespace i2c
+}  // namespace esphome
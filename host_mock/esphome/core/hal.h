@@ -0,0 +1,33 @@
+/**
+ * Host mock: ESPHome timing
+ *
+ * delay() and delayMicroseconds() do not sleep; they add to
+ * host_mock::g_sleep_us so benchmarks and tests can report how long a path
+ * would stall on the device. millis() is a simulated clock driven by the
+ * same sleeps, which keeps timeouts and cooldowns deterministic.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace host_mock {
+
+inline uint64_t g_sleep_us = 0;
+
+inline double sleep_ms() { return g_sleep_us / 1000.0; }
+
+}  // namespace host_mock
+
+namespace esphome {
+
+inline void delay(uint32_t ms) { host_mock::g_sleep_us += static_cast<uint64_t>(ms) * 1000; }
+inline void delayMicroseconds(uint32_t us) { host_mock::g_sleep_us += us; }
+inline uint32_t millis() { return static_cast<uint32_t>(host_mock::g_sleep_us / 1000); }
+
+}  // namespace esphome
+
+// The firmware headers call these unqualified
+using esphome::delay;
+using esphome::delayMicroseconds;
+using esphome::millis;
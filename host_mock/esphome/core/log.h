@@ -0,0 +1,22 @@
+/**
+ * Host mock: ESPHome logging (compiled out)
+ *
+ * The arguments still go through printf inside a dead branch, so format
+ * strings are checked and log-only variables count as used, as on the
+ * device.
+ *
+ * Part of the host mocks used by bench_tas5805m.cpp to build the real
+ * firmware headers without ESPHome. Add -Ihost_mock to the compiler flags.
+ */
+
+#pragma once
+
+#include "esphome/core/hal.h"
+
+#include <cstdio>
+
+#define ESP_LOGE(tag, ...) do { if (0) printf(__VA_ARGS__); } while (0)
+#define ESP_LOGW(tag, ...) do { if (0) printf(__VA_ARGS__); } while (0)
+#define ESP_LOGI(tag, ...) do { if (0) printf(__VA_ARGS__); } while (0)
+#define ESP_LOGD(tag, ...) do { if (0) printf(__VA_ARGS__); } while (0)
+#define ESP_LOGV(tag, ...) do { if (0) printf(__VA_ARGS__); } while (0)
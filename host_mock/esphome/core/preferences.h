@@ -0,0 +1,85 @@
+/**
+ * Host mock: ESPHome preferences, backed by an in-memory map
+ *
+ * Counts save() and sync() calls, so tests can check how often the firmware
+ * touches flash. Saves apply immediately; sync() only counts.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace esphome {
+
+struct PreferenceCounters {
+    uint32_t saves = 0;
+    uint32_t syncs = 0;
+};
+
+class ESPPreferenceObject {
+public:
+    ESPPreferenceObject() = default;
+    ESPPreferenceObject(std::map<uint32_t, std::vector<uint8_t>>* store, PreferenceCounters* counters,
+                        uint32_t key)
+        : store_(store), counters_(counters), key_(key) {}
+
+    template<typename T>
+    bool save(const T* value) {
+        if (store_ == nullptr) return false;
+        counters_->saves++;
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(value);
+        (*store_)[key_].assign(bytes, bytes + sizeof(T));
+        return true;
+    }
+
+    template<typename T>
+    bool load(T* value) {
+        if (store_ == nullptr) return false;
+        auto it = store_->find(key_);
+        if (it == store_->end() || it->second.size() != sizeof(T)) return false;
+        memcpy(value, it->second.data(), sizeof(T));
+        return true;
+    }
+
+private:
+    std::map<uint32_t, std::vector<uint8_t>>* store_{nullptr};
+    PreferenceCounters* counters_{nullptr};
+    uint32_t key_{0};
+};
+
+class ESPPreferences {
+public:
+    template<typename T>
+    ESPPreferenceObject make_preference(uint32_t hash) { return ESPPreferenceObject(&store_, &counters, hash); }
+
+    bool sync() {
+        counters.syncs++;
+        return true;
+    }
+
+    // Forget everything, like a freshly erased NVS partition
+    void clear() {
+        store_.clear();
+        counters = PreferenceCounters();
+    }
+
+    // Total payload bytes held across all keys
+    size_t stored_bytes() const {
+        size_t total = 0;
+        for (const auto& entry : store_) total += entry.second.size();
+        return total;
+    }
+
+    PreferenceCounters counters;
+
+private:
+    std::map<uint32_t, std::vector<uint8_t>> store_;
+};
+
+inline ESPPreferences* global_preferences = new ESPPreferences();
+
+}  // namespace esphome
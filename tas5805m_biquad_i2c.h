@@ -2,7 +2,8 @@
  * TAS5805M Biquad I2C Programming for ESPHome
  *
  * This header provides functions to program the TAS5805M's DSP biquad filters
- * directly via I2C using ESPHome's I2C bus abstraction.
+ * directly via I2C using ESPHome's I2C bus abstraction. The coefficient math
+ * itself lives in tas5805m_dsp_math.h.
  *
  * Usage in ESPHome lambda:
  *   #include "tas5805m_biquad_i2c.h"
@@ -12,8 +13,13 @@
 #pragma once
 
 #include "esphome/components/i2c/i2c.h"
+#include "esphome/core/log.h"
+#include "tas5805m_dsp_math.h"
+#include "tas5805m_perf.h"
 #include <cstdint>
+#include <cstring>
 #include <cmath>
+#include <type_traits>
 
 namespace tas5805m_biquad {
 
@@ -30,114 +36,18 @@ constexpr uint8_t REG_BOOK_SELECT = 0x7F;
 // Biquad coefficient book
 constexpr uint8_t BOOK_COEFF = 0xAA;
 
+// Device control (book 0, page 0)
+constexpr uint8_t REG_DEVICE_CTRL2 = 0x03;
+constexpr uint8_t DEVICE_CTRL2_MUTE = 0x08;          // Soft mute, ramps at the DIG_VOL_CTRL2 rate
+
 // I2C timing delays (milliseconds)
-constexpr uint32_t DELAY_I2C_RETRY_MS = 5;           // Wait between I2C retries
 constexpr uint32_t DELAY_PAGE_SELECT_MS = 2;         // Wait after page/book select
 constexpr uint32_t DELAY_COEFF_WRITE_MS = 5;         // Wait after coefficient write
-constexpr uint32_t DELAY_BATCH_PAGE_WRITE_MS = 1;    // Wait between page writes in batch
-
-// =============================================================================
-// VALIDATION HELPERS
-// =============================================================================
-
-/**
- * Validate channel parameter
- * @param channel 0=left, 1=right, 2=both
- * @return true if valid
- */
-inline bool validate_channel(int channel) {
-    if (channel < 0 || channel > 2) {
-        ESP_LOGE("tas5805m_bq", "Invalid channel: %d (must be 0-2)", channel);
-        return false;
-    }
-    return true;
-}
-
-/**
- * Validate biquad index parameter
- * @param index 0-14
- * @return true if valid
- */
-inline bool validate_index(int index) {
-    if (index < 0 || index >= 15) {
-        ESP_LOGE("tas5805m_bq", "Invalid biquad index: %d (must be 0-14)", index);
-        return false;
-    }
-    return true;
-}
+constexpr uint32_t DELAY_MUTE_RAMP_MS = 20;          // Default volume ramp 0dB -> mute at 48kHz
 
-/**
- * Validate frequency parameter
- * @param frequency in Hz
- * @param min_freq minimum allowed frequency (default 10 Hz)
- * @param max_freq maximum allowed frequency (default 24000 Hz)
- * @return true if valid
- */
-inline bool validate_frequency(float frequency, float min_freq = 10.0f, float max_freq = 24000.0f) {
-    if (!std::isfinite(frequency) || frequency < min_freq || frequency > max_freq) {
-        ESP_LOGE("tas5805m_bq", "Invalid frequency: %.1f (must be %.0f-%.0f Hz)", frequency, min_freq, max_freq);
-        return false;
-    }
-    return true;
-}
-
-/**
- * Validate gain parameter
- * @param gain_db in dB
- * @param min_gain minimum allowed gain (default -20 dB)
- * @param max_gain maximum allowed gain (default +20 dB)
- * @return true if valid
- */
-inline bool validate_gain(float gain_db, float min_gain = -20.0f, float max_gain = 20.0f) {
-    if (!std::isfinite(gain_db) || gain_db < min_gain || gain_db > max_gain) {
-        ESP_LOGE("tas5805m_bq", "Invalid gain: %.1f (must be %.0f to +%.0f dB)", gain_db, min_gain, max_gain);
-        return false;
-    }
-    return true;
-}
-
-/**
- * Validate Q factor parameter
- * @param q Q factor
- * @param min_q minimum allowed Q (default 0.1)
- * @param max_q maximum allowed Q (default 20)
- * @return true if valid
- */
-inline bool validate_q(float q, float min_q = 0.1f, float max_q = 20.0f) {
-    if (!std::isfinite(q) || q < min_q || q > max_q) {
-        ESP_LOGE("tas5805m_bq", "Invalid Q: %.2f (must be %.1f-%.0f)", q, min_q, max_q);
-        return false;
-    }
-    return true;
-}
-
-/**
- * Validate slope parameter (for shelf filters)
- * @param slope shelf slope
- * @param min_slope minimum allowed slope (default 0.1)
- * @param max_slope maximum allowed slope (default 5.0)
- * @return true if valid
- */
-inline bool validate_slope(float slope, float min_slope = 0.1f, float max_slope = 5.0f) {
-    if (!std::isfinite(slope) || slope < min_slope || slope > max_slope) {
-        ESP_LOGE("tas5805m_bq", "Invalid slope: %.2f (must be %.1f-%.1f)", slope, min_slope, max_slope);
-        return false;
-    }
-    return true;
-}
-
-/**
- * Validate biquad coefficients
- * @return true if all coefficients are finite
- */
-inline bool validate_coefficients(float b0, float b1, float b2, float a1, float a2) {
-    if (!std::isfinite(b0) || !std::isfinite(b1) || !std::isfinite(b2) ||
-        !std::isfinite(a1) || !std::isfinite(a2)) {
-        ESP_LOGE("tas5805m_bq", "Coefficient contains NaN or Inf");
-        return false;
-    }
-    return true;
-}
+// Largest payload write_bytes accepts (one full page burst: 4 biquads x 20 bytes).
+// The frame (register + payload) is built in a fixed stack buffer, never the heap.
+constexpr size_t MAX_WRITE_BYTES = 80;
 
 // =============================================================================
 // PAGE/OFFSET CONSTANTS
@@ -168,34 +78,229 @@ constexpr uint8_t PAGE_RIGHT_BQ[15] = {
 };
 
 // =============================================================================
-// COEFFICIENT CONVERSION
+// LOG TIMING
 // =============================================================================
 
 /**
- * Convert float to TAS5805M 9.23 fixed-point format
+ * Duration that only feeds a TAS5805M_BQ_LOGx line at Level
+ *
+ * millis() is read only while that level is compiled in, so the timing
+ * goes away together with the log line. Real measurements belong in
+ * tas5805m_perf probes.
  */
-inline int32_t float_to_9_23(float value) {
-    // Check for invalid values (NaN, Infinity)
-    if (!std::isfinite(value)) {
-        ESP_LOGE("tas5805m_bq", "Invalid coefficient: %f (NaN or Inf), using bypass", value);
-        return 0;  // Return bypass coefficient
-    }
+template<int Level>
+class LogStopwatch {
+public:
+    LogStopwatch() : start_ms_(enabled() ? millis() : 0) {}
 
-    // Clamp to valid range for 9.23 format
-    if (value > 255.999999f) value = 255.999999f;
-    if (value < -256.0f) value = -256.0f;
+    unsigned elapsed_ms() const { return enabled() ? static_cast<unsigned>(millis() - start_ms_) : 0u; }
 
-    return static_cast<int32_t>(value * (1 << 23));
+private:
+    uint32_t start_ms_;
+
+    static constexpr bool enabled() { return Level <= TAS5805M_BQ_LOG_LEVEL; }
+};
+
+// =============================================================================
+// REGISTER CURSOR
+// =============================================================================
+
+/**
+ * Book/page the chip is currently pointed at, shared by every TAS5805M_I2C
+ * instance (the helpers are created per call, the chip state is not).
+ *
+ * -1 means unknown. Any failed write invalidates the cursor. Code that changes
+ * book/page behind our back (the tas5805m driver leaves the chip at book 0,
+ * page 0, which is what we assume between calls) must call
+ * invalidate_register_cursor().
+ */
+struct RegisterCursor {
+    int16_t address = -1;
+    int16_t book = -1;
+    int16_t page = -1;
+    int session_depth = 0;  // Open CoeffSession scopes
+};
+
+static RegisterCursor g_register_cursor;
+
+inline void invalidate_register_cursor() {
+    g_register_cursor.book = -1;
+    g_register_cursor.page = -1;
 }
 
+// =============================================================================
+// RETRY POLICY AND BUS HEALTH
+// =============================================================================
+
 /**
- * Pack 32-bit value into big-endian byte buffer
+ * How failed transfers are retried
+ *
+ * Retries back off exponentially from a sub-millisecond first delay, so a
+ * one-off NACK costs well under a millisecond. Within a CoeffSession (one
+ * profile apply) the failed attempts share a budget; once it is spent the
+ * remaining transfers fail immediately instead of each burning its retries.
+ *
+ * Change at runtime via tas5805m_biquad::retry_policy().
  */
-inline void pack_be32(int32_t value, uint8_t* buffer) {
-    buffer[0] = (value >> 24) & 0xFF;
-    buffer[1] = (value >> 16) & 0xFF;
-    buffer[2] = (value >> 8) & 0xFF;
-    buffer[3] = value & 0xFF;
+struct RetryPolicy {
+    uint8_t max_attempts = 3;                 // Per transfer, first try included
+    uint32_t first_backoff_us = 250;          // Delay before the first retry
+    uint8_t backoff_multiplier = 4;           // 250 us, 1 ms, 4 ms, ...
+    uint32_t max_backoff_us = 5000;
+    uint8_t session_failure_budget = 4;       // Failed attempts per CoeffSession
+    uint8_t breaker_threshold = 3;            // Consecutive failed transfers that open the breaker
+    uint32_t breaker_cooldown_ms = 1000;      // First open period, doubles while the chip stays dead
+    uint32_t breaker_max_cooldown_ms = 30000;
+};
+
+static RetryPolicy g_retry_policy;
+
+inline RetryPolicy& retry_policy() { return g_retry_policy; }
+
+enum class BreakerState : uint8_t {
+    CLOSED,      // Normal operation
+    OPEN,        // Chip not responding: transfers fail without touching the bus
+    HALF_OPEN,   // Cooldown over: the next transfer gets one attempt as a probe
+};
+
+/**
+ * Circuit breaker and per-session failure budget, shared by all transfers
+ *
+ * After breaker_threshold consecutive failed transfers the breaker opens
+ * and every transfer fails fast for the cooldown. Then one probe attempt is
+ * let through: success closes the breaker, failure reopens it with twice the
+ * cooldown.
+ */
+class BusHealth {
+public:
+    /**
+     * May a transfer start, and with how many attempts? 0 = fail fast.
+     */
+    uint8_t attempts_allowed() {
+        const RetryPolicy& policy = g_retry_policy;
+
+        if (state_ == BreakerState::OPEN) {
+            if (millis() - opened_ms_ < cooldown_ms_) {
+                tas5805m_perf::count_i2c_fast_failure();
+                return 0;
+            }
+            state_ = BreakerState::HALF_OPEN;
+        }
+        if (state_ == BreakerState::HALF_OPEN) return 1;
+
+        if (session_active() && session_failures_ >= policy.session_failure_budget) {
+            if (!session_aborted_) {
+                session_aborted_ = true;
+                tas5805m_perf::count_i2c_budget_abort();
+                TAS5805M_BQ_LOGE("I2C failure budget (%d) spent, aborting the rest of this apply",
+                                 (int)policy.session_failure_budget);
+            }
+            tas5805m_perf::count_i2c_fast_failure();
+            return 0;
+        }
+        return policy.max_attempts;
+    }
+
+    /**
+     * May a failed attempt be retried?
+     */
+    bool can_retry() const {
+        return state_ == BreakerState::CLOSED &&
+               !(session_active() && session_failures_ >= g_retry_policy.session_failure_budget);
+    }
+
+    void on_attempt_failed() {
+        if (session_active()) session_failures_++;
+    }
+
+    void on_transfer_ok() {
+        if (state_ != BreakerState::CLOSED) {
+            TAS5805M_BQ_LOGI("I2C bus recovered, circuit breaker closed");
+        }
+        state_ = BreakerState::CLOSED;
+        consecutive_failures_ = 0;
+        cooldown_ms_ = g_retry_policy.breaker_cooldown_ms;
+    }
+
+    void on_transfer_failed(uint8_t reg) {
+        const RetryPolicy& policy = g_retry_policy;
+        consecutive_failures_++;
+        last_failed_reg_ = reg;
+
+        if (state_ == BreakerState::HALF_OPEN) {
+            uint32_t doubled = cooldown_ms_ * 2;
+            cooldown_ms_ = doubled < policy.breaker_max_cooldown_ms ? doubled : policy.breaker_max_cooldown_ms;
+            open();
+        } else if (state_ == BreakerState::CLOSED && consecutive_failures_ >= policy.breaker_threshold) {
+            cooldown_ms_ = policy.breaker_cooldown_ms;
+            open();
+        }
+    }
+
+    /**
+     * Outermost CoeffSession boundaries: each apply gets a fresh budget
+     */
+    void reset_session() {
+        session_failures_ = 0;
+        session_aborted_ = false;
+    }
+
+    BreakerState state() const { return state_; }
+
+    // Register of the most recent transfer that failed all its attempts (-1 = none)
+    int last_failed_reg() const { return last_failed_reg_; }
+
+    uint32_t cooldown_remaining_ms() const {
+        if (state_ != BreakerState::OPEN) return 0;
+        uint32_t elapsed = millis() - opened_ms_;
+        return elapsed < cooldown_ms_ ? cooldown_ms_ - elapsed : 0;
+    }
+
+    // Close the breaker before its cooldown ends, for a deliberate retry
+    // (last_failed_reg() is kept for diagnostics)
+    void close() {
+        state_ = BreakerState::CLOSED;
+        consecutive_failures_ = 0;
+        cooldown_ms_ = g_retry_policy.breaker_cooldown_ms;
+        reset_session();
+    }
+
+    // Forget all history (tests, or after re-powering the amplifier)
+    void reset() {
+        close();
+        last_failed_reg_ = -1;
+    }
+
+private:
+    BreakerState state_ = BreakerState::CLOSED;
+    uint32_t consecutive_failures_ = 0;
+    uint32_t opened_ms_ = 0;
+    uint32_t cooldown_ms_ = 1000;
+    uint32_t session_failures_ = 0;
+    bool session_aborted_ = false;
+    int16_t last_failed_reg_ = -1;
+
+    static bool session_active() { return g_register_cursor.session_depth > 0; }
+
+    void open() {
+        state_ = BreakerState::OPEN;
+        opened_ms_ = millis();
+        tas5805m_perf::count_i2c_breaker_trip();
+        TAS5805M_BQ_LOGE("TAS5805M not responding, failing I2C fast for %u ms", (unsigned)cooldown_ms_);
+    }
+};
+
+static BusHealth g_bus_health;
+
+inline BusHealth& bus_health() { return g_bus_health; }
+
+inline const char* breaker_state_name(BreakerState state) {
+    switch (state) {
+        case BreakerState::CLOSED:    return "ok";
+        case BreakerState::OPEN:      return "open";
+        case BreakerState::HALF_OPEN: return "half-open";
+        default:                      return "?";
+    }
 }
 
 // =============================================================================
@@ -208,191 +313,483 @@ inline void pack_be32(int32_t value, uint8_t* buffer) {
 class TAS5805M_I2C {
 public:
     TAS5805M_I2C(esphome::i2c::I2CBus* bus, uint8_t address = TAS5805M_ADDR)
-        : bus_(bus), address_(address) {}
+        : bus_(bus), address_(address) {
+        if (g_register_cursor.address != address_) {
+            invalidate_register_cursor();
+            g_register_cursor.address = address_;
+        }
+    }
 
     /**
      * Write a single byte to a register (with retry logic)
      */
     bool write_byte(uint8_t reg, uint8_t value) {
-        const int MAX_RETRIES = 3;
+        uint8_t data[2] = {reg, value};
+        bool ok = transfer(reg, [&]() { return bus_->write(address_, data, 2, true); });
 
-        for (int attempt = 0; attempt < MAX_RETRIES; attempt++) {
-            uint8_t data[2] = {reg, value};
-            auto err = bus_->write(address_, data, 2, true);
+        if (ok) {
+            track_select(reg, value);
+        } else {
+            invalidate_register_cursor();
+        }
+        return ok;
+    }
 
+    /**
+     * Read a single byte from a register in the current book/page (with retry logic)
+     */
+    bool read_byte(uint8_t reg, uint8_t& value) {
+        return transfer(reg, [&]() {
+            auto err = bus_->write(address_, &reg, 1, false);
             if (err == esphome::i2c::ERROR_OK) {
-                return true;  // Success
+                err = bus_->read(address_, &value, 1);
             }
+            return err;
+        });
+    }
 
-            ESP_LOGW("tas5805m_bq", "I2C write failed (attempt %d/%d): reg=0x%02X val=0x%02X err=%d",
-                     attempt + 1, MAX_RETRIES, reg, value, (int)err);
-
-            if (attempt < MAX_RETRIES - 1) {
-                delay(DELAY_I2C_RETRY_MS);
+    /**
+     * Read a block starting at a register in the current book/page (with retry logic)
+     *
+     * One register-pointer write plus one auto-increment read, so a full
+     * page of coefficients comes back in a single transaction.
+     */
+    bool read_bytes(uint8_t reg, uint8_t* data, size_t len) {
+        return transfer(reg, [&]() {
+            auto err = bus_->write(address_, &reg, 1, false);
+            if (err == esphome::i2c::ERROR_OK) {
+                err = bus_->read(address_, data, len);
             }
-        }
-
-        ESP_LOGE("tas5805m_bq", "I2C write failed after %d attempts: reg=0x%02X val=0x%02X",
-                 MAX_RETRIES, reg, value);
-        return false;
+            return err;
+        });
     }
 
     /**
      * Write multiple bytes starting at a register (with retry logic)
+     *
+     * Allocation-free: the frame is built once in a fixed stack buffer.
+     * Requests longer than MAX_WRITE_BYTES are rejected, not split.
      */
     bool write_bytes(uint8_t reg, const uint8_t* data, size_t len) {
-        const int MAX_RETRIES = 3;
-
-        for (int attempt = 0; attempt < MAX_RETRIES; attempt++) {
-            // Allocate buffer for register + data
-            std::vector<uint8_t> buffer(len + 1);
-            buffer[0] = reg;
-            memcpy(&buffer[1], data, len);
+        tas5805m_perf::ScopedProbe probe(tas5805m_perf::Probe::WRITE_BYTES);
 
-            auto err = bus_->write(address_, buffer.data(), buffer.size(), true);
-
-            if (err == esphome::i2c::ERROR_OK) {
-                return true;  // Success
-            }
+        if (len > MAX_WRITE_BYTES) {
+            TAS5805M_BQ_LOGE("write_bytes: %d bytes exceeds max %d (reg=0x%02X)",
+                     (int)len, (int)MAX_WRITE_BYTES, reg);
+            return probe.fail();
+        }
 
-            ESP_LOGW("tas5805m_bq", "I2C write_bytes failed (attempt %d/%d): reg=0x%02X len=%d err=%d",
-                     attempt + 1, MAX_RETRIES, reg, (int)len, (int)err);
+        // Register address + payload
+        uint8_t buffer[1 + MAX_WRITE_BYTES];
+        buffer[0] = reg;
+        memcpy(&buffer[1], data, len);
 
-            if (attempt < MAX_RETRIES - 1) {
-                delay(DELAY_I2C_RETRY_MS);
-            }
+        if (!transfer(reg, [&]() { return bus_->write(address_, buffer, len + 1, true); })) {
+            invalidate_register_cursor();
+            return probe.fail();
         }
-
-        ESP_LOGE("tas5805m_bq", "I2C write_bytes failed after %d attempts: reg=0x%02X len=%d",
-                 MAX_RETRIES, reg, (int)len);
-        return false;
+        return true;
     }
 
     /**
      * Select book and page for coefficient access
+     *
+     * Only writes the registers that actually change: staying in the same
+     * book costs one page write, staying on the same page costs nothing.
+     *
+     * @param settle Sleep after a page-only change (burst writes pass false;
+     *               a book change always settles)
      */
-    bool select_book_page(uint8_t book, uint8_t page) {
-        // First go to page 0 to access book register
-        if (!write_byte(REG_PAGE_SELECT, 0x00)) return false;
-        delay(DELAY_PAGE_SELECT_MS);
+    bool select_book_page(uint8_t book, uint8_t page, bool settle = true) {
+        if (g_register_cursor.book == book && g_register_cursor.page == page) return true;
+
+        tas5805m_perf::ScopedProbe probe(tas5805m_perf::Probe::SELECT_BOOK_PAGE);
 
-        // Select book
-        if (!write_byte(REG_BOOK_SELECT, book)) return false;
-        delay(DELAY_PAGE_SELECT_MS);
+        if (g_register_cursor.book != book) {
+            // The book register is only reachable from page 0
+            if (g_register_cursor.page != 0) {
+                if (!write_byte(REG_PAGE_SELECT, 0x00)) return probe.fail();
+                delay(DELAY_PAGE_SELECT_MS);
+            }
+
+            // Select book
+            if (!write_byte(REG_BOOK_SELECT, book)) return probe.fail();
+            delay(DELAY_PAGE_SELECT_MS);
+        }
 
         // Select page within book
-        if (!write_byte(REG_PAGE_SELECT, page)) return false;
-        delay(DELAY_PAGE_SELECT_MS);
+        if (g_register_cursor.page != page) {
+            if (!write_byte(REG_PAGE_SELECT, page)) return probe.fail();
+            if (settle) delay(DELAY_PAGE_SELECT_MS);
+        }
 
         return true;
     }
 
     /**
      * Return to normal operation (book 0, page 0)
+     *
+     * Deferred while a CoeffSession is open; the session does it once on exit.
      */
     bool return_to_normal() {
-        if (!write_byte(REG_PAGE_SELECT, 0x00)) return false;
-        if (!write_byte(REG_BOOK_SELECT, 0x00)) return false;
-        return true;
+        if (g_register_cursor.session_depth > 0) return true;
+        return select_book_page(0x00, 0x00);
     }
 
 private:
     esphome::i2c::I2CBus* bus_;
     uint8_t address_;
+
+    /**
+     * Run one bus transfer under the retry policy and circuit breaker
+     *
+     * @param attempt Callable performing a single try, returning an ErrorCode
+     */
+    template<typename Attempt>
+    bool transfer(uint8_t reg, Attempt attempt) {
+        uint8_t attempts = g_bus_health.attempts_allowed();
+        if (attempts == 0) return false;  // Breaker open or session budget spent
+
+        uint32_t backoff_us = g_retry_policy.first_backoff_us;
+        for (uint8_t n = 1; n <= attempts; n++) {
+            auto err = attempt();
+            if (err == esphome::i2c::ERROR_OK) {
+                g_bus_health.on_transfer_ok();
+                return true;
+            }
+
+            TAS5805M_BQ_LOGW("I2C transfer failed (attempt %d/%d): reg=0x%02X err=%d",
+                             n, attempts, reg, (int)err);
+            g_bus_health.on_attempt_failed();
+
+            if (n == attempts || !g_bus_health.can_retry()) break;
+
+            tas5805m_perf::count_i2c_retry();
+            delayMicroseconds(backoff_us);
+            uint32_t next = backoff_us * g_retry_policy.backoff_multiplier;
+            backoff_us = next < g_retry_policy.max_backoff_us ? next : g_retry_policy.max_backoff_us;
+        }
+
+        TAS5805M_BQ_LOGE("I2C transfer failed: reg=0x%02X", reg);
+        tas5805m_perf::count_i2c_failure();
+        g_bus_health.on_transfer_failed(reg);
+        return false;
+    }
+
+    // Keep the cursor in step with successful page/book register writes
+    static void track_select(uint8_t reg, uint8_t value) {
+        if (reg == REG_PAGE_SELECT) {
+            g_register_cursor.page = value;
+        } else if (reg == REG_BOOK_SELECT && g_register_cursor.page == 0) {
+            g_register_cursor.book = value;
+        }
+    }
+};
+
+/**
+ * Scope that groups several coefficient writes into one book-0xAA session
+ *
+ * While a session is open, return_to_normal() is a no-op, so a burst of edits
+ * only switches back to book 0 once, when the outermost session closes.
+ * Sessions nest. The outermost session is also the scope of the retry
+ * policy's failure budget.
+ *
+ * Usage:
+ *   {
+ *       tas5805m_biquad::CoeffSession session(id(i2c_bus), id(tas5805m_addr));
+ *       write_parametric_eq(...);
+ *       write_parametric_eq(...);
+ *   }  // back to book 0 here
+ */
+class CoeffSession {
+public:
+    CoeffSession(esphome::i2c::I2CBus* bus, uint8_t address) : dev_(bus, address) {
+        if (g_register_cursor.session_depth++ == 0) g_bus_health.reset_session();
+    }
+
+    ~CoeffSession() {
+        if (--g_register_cursor.session_depth == 0) {
+            // Even an aborted apply gets a fresh attempt at leaving the coefficient book
+            g_bus_health.reset_session();
+            dev_.return_to_normal();
+        }
+    }
+
+    CoeffSession(const CoeffSession&) = delete;
+    CoeffSession& operator=(const CoeffSession&) = delete;
+
+private:
+    TAS5805M_I2C dev_;
 };
 
 // =============================================================================
-// BIQUAD PROGRAMMING FUNCTIONS
+// WIRE FORMAT & COEFFICIENT SHADOW
 // =============================================================================
 
+constexpr size_t BIQUADS_PER_PAGE = 4;
+constexpr size_t MAX_BURST_BYTES = BIQUADS_PER_PAGE * BIQUAD_WIRE_BYTES;  // 80
+
+static_assert(MAX_BURST_BYTES <= MAX_WRITE_BYTES,
+              "write_bytes scratch buffer must hold a full page burst");
+
 /**
- * Write biquad coefficients to TAS5805M
+ * Page address for a biquad on a single channel
+ * @param channel 0=left, 1=right
+ */
+inline uint8_t biquad_page(int channel, int index) {
+    return (channel == 0) ? PAGE_LEFT_BQ[index] : PAGE_RIGHT_BQ[index];
+}
+
+/**
+ * True if biquad index + 1 starts exactly where index ends (same page, no gap
+ * in OFFSET_BQ), i.e. both can go out in one auto-increment write
+ */
+inline bool biquads_adjacent(int channel, int index) {
+    return index + 1 < (int)BIQUADS_PER_CHANNEL &&
+           biquad_page(channel, index + 1) == biquad_page(channel, index) &&
+           OFFSET_BQ[index + 1] == OFFSET_BQ[index] + BIQUAD_WIRE_BYTES;
+}
+
+/**
+ * Device-side copy of the coefficient memory, in wire form.
  *
- * @param bus ESPHome I2C bus pointer (use id(i2c_bus))
- * @param address I2C address (typically 0x2C)
- * @param channel 0=left, 1=right, 2=both
- * @param index Biquad index 0-14
- * @param b0, b1, b2, a1, a2 Float coefficients (normalized, a0=1)
- * @return true on success
+ * Tracks what is actually in the DSP so writes can be skipped (or reduced to
+ * the biquads that differ). A slot is "known" only after a successful write;
+ * failed writes and anything else touching coefficient memory (e.g. the
+ * tas5805m driver's graphic EQ, whose number and switch entities call
+ * invalidate_coeff_shadow() from on_value / on_turn_*) must invalidate it.
  */
-inline bool write_biquad(esphome::i2c::I2CBus* bus, uint8_t address,
-                         int channel, int index,
-                         float b0, float b1, float b2, float a1, float a2) {
+class CoeffShadow {
+public:
+    CoeffShadow() { invalidate(); }
+
+    bool is_known(int channel, int index) const {
+        return (known_[channel] >> index) & 1;
+    }
+
+    // True if the slot is known and holds exactly these bytes
+    bool matches(int channel, int index, const uint8_t* wire) const {
+        return is_known(channel, index) &&
+               memcmp(wire_[channel][index], wire, BIQUAD_WIRE_BYTES) == 0;
+    }
+
+    const uint8_t* get(int channel, int index) const {
+        return wire_[channel][index];
+    }
+
+    void update(int channel, int index, const uint8_t* wire) {
+        memcpy(wire_[channel][index], wire, BIQUAD_WIRE_BYTES);
+        known_[channel] |= (1u << index);
+    }
+
+    void invalidate(int channel, int index) {
+        known_[channel] &= ~(1u << index);
+    }
+
+    void invalidate() {
+        known_[0] = 0;
+        known_[1] = 0;
+    }
+
+private:
+    uint8_t wire_[2][BIQUADS_PER_CHANNEL][BIQUAD_WIRE_BYTES];
+    uint16_t known_[2];
+};
+
+// The coefficient paths keep all state in fixed-size, statically allocated
+// objects; these catch anyone adding a heap-owning member.
+static_assert(std::is_trivially_copyable<CoeffShadow>::value &&
+              std::is_trivially_destructible<CoeffShadow>::value,
+              "CoeffShadow must not own heap memory");
+static_assert(std::is_trivially_destructible<RegisterCursor>::value,
+              "RegisterCursor must not own heap memory");
+
+// Single TAS5805M per board, so one shadow
+static CoeffShadow g_coeff_shadow;
+
+inline CoeffShadow& coeff_shadow() { return g_coeff_shadow; }
 
-    if (index < 0 || index >= 15) {
-        ESP_LOGE("tas5805m_bq", "Invalid biquad index: %d (must be 0-14)", index);
+/**
+ * Forget everything the shadow knows (forces the next apply to write all)
+ */
+inline void invalidate_coeff_shadow() { g_coeff_shadow.invalidate(); }
+
+/**
+ * Write a run of adjacent biquads on one page in a single transaction
+ *
+ * Biquads within a page sit back-to-back in OFFSET_BQ (20 bytes apart), so
+ * a run starting at first_index can be sent as one auto-increment write of
+ * up to 80 bytes. The caller guarantees the run is adjacent (see
+ * biquads_adjacent). Updates the shadow on success, invalidates the run on
+ * failure.
+ *
+ * @param wire count * 20 bytes of packed coefficients
+ * @param settle Sleep after the page select (false for burst paths)
+ */
+inline bool write_biquad_run(TAS5805M_I2C& dev, int channel, int first_index,
+                             size_t count, const uint8_t* wire, bool settle = true) {
+    if (count == 0 || count * BIQUAD_WIRE_BYTES > MAX_BURST_BYTES) return false;
+
+    uint8_t page = biquad_page(channel, first_index);
+
+    if (!dev.select_book_page(BOOK_COEFF, page, settle)) {
+        TAS5805M_BQ_LOGE("Failed to select page 0x%02X", page);
+        for (size_t i = 0; i < count; i++) {
+            g_coeff_shadow.invalidate(channel, first_index + i);
+        }
         return false;
     }
 
-    TAS5805M_I2C dev(bus, address);
+    bool ok = dev.write_bytes(OFFSET_BQ[first_index], wire, count * BIQUAD_WIRE_BYTES);
 
-    // Convert to 9.23 fixed-point
-    // Note: TAS5805M expects a1 and a2 with inverted signs!
-    int32_t b0_fp = float_to_9_23(b0);
-    int32_t b1_fp = float_to_9_23(b1);
-    int32_t b2_fp = float_to_9_23(b2);
-    int32_t a1_fp = float_to_9_23(-a1);  // Sign inverted!
-    int32_t a2_fp = float_to_9_23(-a2);  // Sign inverted!
+    for (size_t i = 0; i < count; i++) {
+        if (ok) {
+            g_coeff_shadow.update(channel, first_index + i, &wire[i * BIQUAD_WIRE_BYTES]);
+        } else {
+            g_coeff_shadow.invalidate(channel, first_index + i);
+        }
+    }
 
-    // Pack coefficients into 20-byte buffer
-    uint8_t coeff_buf[20];
-    pack_be32(b0_fp, &coeff_buf[0]);
-    pack_be32(b1_fp, &coeff_buf[4]);
-    pack_be32(b2_fp, &coeff_buf[8]);
-    pack_be32(a1_fp, &coeff_buf[12]);
-    pack_be32(a2_fp, &coeff_buf[16]);
-
-    ESP_LOGD("tas5805m_bq", "Writing biquad ch=%d idx=%d", channel, index);
-    ESP_LOGD("tas5805m_bq", "  b0=%.6f b1=%.6f b2=%.6f a1=%.6f a2=%.6f", b0, b1, b2, a1, a2);
-    ESP_LOGD("tas5805m_bq", "  FP: b0=0x%08X b1=0x%08X b2=0x%08X a1=0x%08X a2=0x%08X",
-             b0_fp, b1_fp, b2_fp, a1_fp, a2_fp);
+    if (!ok) {
+        TAS5805M_BQ_LOGE("Failed to write BQ%d-%d on page 0x%02X",
+                 first_index, first_index + (int)count - 1, page);
+    }
+    return ok;
+}
 
+/**
+ * Write only the biquads of one channel that differ from the shadow
+ *
+ * Differing biquads are grouped into adjacent runs within a page, so each
+ * run costs at most one page select and one burst write, with no sleeps.
+ *
+ * @param wire 15 * 20 bytes of packed coefficients for the channel
+ * @param writes_out Optional counter incremented per coefficient write issued
+ * @param mask Bit i set = consider biquad i (others are left untouched and
+ *             their bytes in wire are ignored)
+ * @return true on success (including "nothing to do")
+ */
+inline bool write_channel_delta(TAS5805M_I2C& dev, int channel, const uint8_t* wire,
+                                int* writes_out = nullptr, uint16_t mask = 0x7FFF) {
     bool success = true;
+    int index = 0;
 
-    // Write to left channel if requested
-    if (channel == 0 || channel == 2) {
-        uint8_t page = PAGE_LEFT_BQ[index];
-        uint8_t offset = OFFSET_BQ[index];
+    auto needs_write = [&](int i) {
+        return (mask & (1u << i)) &&
+               !g_coeff_shadow.matches(channel, i, &wire[i * BIQUAD_WIRE_BYTES]);
+    };
 
-        if (!dev.select_book_page(BOOK_COEFF, page)) {
-            ESP_LOGE("tas5805m_bq", "Failed to select book/page for left channel");
-            return false;
+    while (index < (int)BIQUADS_PER_CHANNEL) {
+        if (!needs_write(index)) {
+            index++;
+            continue;
         }
 
-        if (!dev.write_bytes(offset, coeff_buf, 20)) {
-            ESP_LOGE("tas5805m_bq", "Failed to write left channel coefficients");
+        // Extend the run while biquads differ and stay adjacent on the page
+        int end = index + 1;
+        while (biquads_adjacent(channel, end - 1) && needs_write(end)) {
+            end++;
+        }
+
+        if (!write_biquad_run(dev, channel, index, end - index,
+                              &wire[index * BIQUAD_WIRE_BYTES], false)) {
             success = false;
-        } else {
-            ESP_LOGI("tas5805m_bq", "Left channel BQ%d written (page=0x%02X offset=0x%02X)",
-                     index, page, offset);
         }
-        delay(DELAY_COEFF_WRITE_MS);
+        if (writes_out != nullptr) (*writes_out)++;
+
+        index = end;
+    }
+
+    return success;
+}
+
+// =============================================================================
+// BIQUAD PROGRAMMING FUNCTIONS
+// =============================================================================
+
+/**
+ * Write one already packed biquad (20 bytes, see pack_coeffs) to one or
+ * both channels, skipping channels whose DSP memory already matches
+ *
+ * Used by write_biquad; a constexpr design_* result goes in as .bytes.
+ */
+inline bool write_biquad_wire(esphome::i2c::I2CBus* bus, uint8_t address,
+                              int channel, int index, const uint8_t* coeff_buf) {
+    if (!validate_channel(channel) || !validate_index(index)) return false;
+
+    bool write_left = (channel == 0 || channel == 2);
+    bool write_right = (channel == 1 || channel == 2);
+
+    // Skip channels whose DSP memory already holds these exact bytes
+    if (write_left && g_coeff_shadow.matches(0, index, coeff_buf)) write_left = false;
+    if (write_right && g_coeff_shadow.matches(1, index, coeff_buf)) write_right = false;
+
+    if (!write_left && !write_right) {
+        TAS5805M_BQ_LOGD("Biquad ch=%d idx=%d unchanged, skipping write", channel, index);
+        return true;
     }
 
-    // Write to right channel if requested
-    if (channel == 1 || channel == 2) {
-        uint8_t page = PAGE_RIGHT_BQ[index];
-        uint8_t offset = OFFSET_BQ[index];
+    TAS5805M_I2C dev(bus, address);
+    bool success = true;
 
-        if (!dev.select_book_page(BOOK_COEFF, page)) {
-            ESP_LOGE("tas5805m_bq", "Failed to select book/page for right channel");
-            return false;
+    // Write to left channel if requested
+    if (write_left) {
+        if (!write_biquad_run(dev, 0, index, 1, coeff_buf)) {
+            TAS5805M_BQ_LOGE("Failed to write left channel coefficients");
+            success = false;
         }
+    }
 
-        if (!dev.write_bytes(offset, coeff_buf, 20)) {
-            ESP_LOGE("tas5805m_bq", "Failed to write right channel coefficients");
+    // Write to right channel if requested. A stereo edit goes out as one
+    // sweep: the right page follows the left one in the same book, without
+    // a settle in between
+    if (write_right) {
+        if (!write_biquad_run(dev, 1, index, 1, coeff_buf, !write_left)) {
+            TAS5805M_BQ_LOGE("Failed to write right channel coefficients");
             success = false;
-        } else {
-            ESP_LOGI("tas5805m_bq", "Right channel BQ%d written (page=0x%02X offset=0x%02X)",
-                     index, page, offset);
         }
-        delay(DELAY_COEFF_WRITE_MS);
     }
 
+    // One settle covers both channels
+    delay(DELAY_COEFF_WRITE_MS);
+
     // Return to normal operation
     dev.return_to_normal();
 
-    return success;
+    // One line per call, not per channel
+    TAS5805M_BQ_LOGD("BQ%d written (%s, offset=0x%02X)", index,
+                     write_left && write_right ? "L+R" : (write_left ? "L" : "R"), OFFSET_BQ[index]);
+
+    return success;
+}
+
+/**
+ * Write biquad coefficients to TAS5805M
+ *
+ * @param bus ESPHome I2C bus pointer (use id(i2c_bus))
+ * @param address I2C address (typically 0x2C)
+ * @param channel 0=left, 1=right, 2=both
+ * @param index Biquad index 0-14
+ * @param b0, b1, b2, a1, a2 Float coefficients (normalized, a0=1)
+ * @return true on success
+ */
+inline bool write_biquad(esphome::i2c::I2CBus* bus, uint8_t address,
+                         int channel, int index,
+                         float b0, float b1, float b2, float a1, float a2) {
+
+    if (!validate_channel(channel) || !validate_index(index)) return false;
+
+    // Pack coefficients into 20-byte buffer
+    // Note: TAS5805M expects a1 and a2 with inverted signs!
+    uint8_t coeff_buf[BIQUAD_WIRE_BYTES];
+    pack_coeffs(b0, b1, b2, a1, a2, coeff_buf);
+
+    TAS5805M_BQ_LOGV("  b0=%.6f b1=%.6f b2=%.6f a1=%.6f a2=%.6f", b0, b1, b2, a1, a2);
+    TAS5805M_BQ_LOGV("  FP: b0=0x%08X b1=0x%08X b2=0x%08X a1=0x%08X a2=0x%08X",
+                     float_to_9_23(b0), float_to_9_23(b1), float_to_9_23(b2),
+                     float_to_9_23(-a1), float_to_9_23(-a2));
+
+    return write_biquad_wire(bus, address, channel, index, coeff_buf);
 }
 
 /**
@@ -407,19 +804,20 @@ inline bool reset_biquad(esphome::i2c::I2CBus* bus, uint8_t address,
  * Reset all 30 biquads to bypass
  */
 inline bool reset_all_biquads(esphome::i2c::I2CBus* bus, uint8_t address) {
-    ESP_LOGI("tas5805m_bq", "Resetting all 30 biquads to bypass");
+    // One session: stay in the coefficient book until all 15 are done
+    CoeffSession session(bus, address);
 
     bool success = true;
     for (int bq = 0; bq < 15; bq++) {
         // Write bypass to both channels
         if (!reset_biquad(bus, address, 2, bq)) {
-            ESP_LOGE("tas5805m_bq", "Failed to reset biquad %d", bq);
+            TAS5805M_BQ_LOGE("Failed to reset biquad %d", bq);
             success = false;
         }
     }
 
     if (success) {
-        ESP_LOGI("tas5805m_bq", "All biquads reset to bypass");
+        TAS5805M_BQ_LOGI("All biquads reset to bypass");
     }
     return success;
 }
@@ -428,30 +826,13 @@ inline bool reset_all_biquads(esphome::i2c::I2CBus* bus, uint8_t address) {
 // BATCHED BIQUAD PROGRAMMING (OPTIMIZED)
 // =============================================================================
 
-/**
- * Biquad coefficient set for batched operations
- */
-struct BiquadCoeffs {
-    float b0, b1, b2, a1, a2;
-
-    BiquadCoeffs() : b0(1.0f), b1(0.0f), b2(0.0f), a1(0.0f), a2(0.0f) {}
-    BiquadCoeffs(float _b0, float _b1, float _b2, float _a1, float _a2)
-        : b0(_b0), b1(_b1), b2(_b2), a1(_a1), a2(_a2) {}
-
-    // Check if this is a bypass filter (passthrough)
-    bool is_bypass() const {
-        return (std::fabs(b0 - 1.0f) < 0.0001f &&
-                std::fabs(b1) < 0.0001f &&
-                std::fabs(b2) < 0.0001f &&
-                std::fabs(a1) < 0.0001f &&
-                std::fabs(a2) < 0.0001f);
-    }
-};
-
 /**
  * Write multiple biquads to a single page efficiently
  *
- * This avoids repeated page selection when biquads share the same page.
+ * All requested biquads are packed up front and sent as burst writes: one
+ * auto-increment transaction per adjacent run (normally the whole page, up
+ * to 80 bytes), split only where OFFSET_BQ has a gap. No sleeps between
+ * bursts.
  * Page layout: biquads 0-3 on first page, 4-7 on second, etc.
  *
  * @param dev TAS5805M_I2C device (must already be initialized)
@@ -464,41 +845,51 @@ struct BiquadCoeffs {
 inline bool write_biquads_page(TAS5805M_I2C& dev, uint8_t page,
                                 const BiquadCoeffs* biquads, size_t count,
                                 size_t start_offset = 0) {
-    if (count == 0 || count > 4) return false;
-
-    // Select the page once
-    if (!dev.select_book_page(BOOK_COEFF, page)) {
-        ESP_LOGE("tas5805m_bq", "Failed to select page 0x%02X", page);
+    if (count == 0 || start_offset + count > BIQUADS_PER_PAGE) return false;
+
+    // Locate the page in the channel maps so the shadow stays in sync
+    int channel = -1;
+    int first_index = 0;
+    for (int ch = 0; ch < 2 && channel < 0; ch++) {
+        for (size_t i = 0; i < BIQUADS_PER_CHANNEL; i += BIQUADS_PER_PAGE) {
+            if (biquad_page(ch, i) != page) continue;
+            channel = ch;
+            first_index = static_cast<int>(i + start_offset);
+            break;
+        }
+    }
+    if (channel < 0) {
+        TAS5805M_BQ_LOGE("Page 0x%02X holds no biquads", page);
+        return false;
+    }
+    if (first_index + count > BIQUADS_PER_CHANNEL) {
+        TAS5805M_BQ_LOGE("Page 0x%02X has no biquads %d-%d", page, first_index,
+                         first_index + (int)count - 1);
         return false;
     }
 
+    // Convert to 9.23 fixed-point with sign inversion for a1/a2
+    uint8_t burst[MAX_BURST_BYTES];
+    for (size_t i = 0; i < count; i++) {
+        pack_biquad(biquads[i], &burst[i * BIQUAD_WIRE_BYTES]);
+    }
+
     bool success = true;
 
-    // Write each biquad on this page
-    for (size_t i = 0; i < count; i++) {
-        uint8_t offset = OFFSET_BQ[start_offset + i];
-
-        // Convert to 9.23 fixed-point with sign inversion for a1/a2
-        int32_t b0_fp = float_to_9_23(biquads[i].b0);
-        int32_t b1_fp = float_to_9_23(biquads[i].b1);
-        int32_t b2_fp = float_to_9_23(biquads[i].b2);
-        int32_t a1_fp = float_to_9_23(-biquads[i].a1);
-        int32_t a2_fp = float_to_9_23(-biquads[i].a2);
-
-        // Pack coefficients
-        uint8_t coeff_buf[20];
-        pack_be32(b0_fp, &coeff_buf[0]);
-        pack_be32(b1_fp, &coeff_buf[4]);
-        pack_be32(b2_fp, &coeff_buf[8]);
-        pack_be32(a1_fp, &coeff_buf[12]);
-        pack_be32(a2_fp, &coeff_buf[16]);
-
-        if (!dev.write_bytes(offset, coeff_buf, 20)) {
-            ESP_LOGE("tas5805m_bq", "Failed to write biquad at offset 0x%02X", offset);
+    // One burst per adjacent run
+    size_t run_start = 0;
+    while (run_start < count) {
+        size_t run_end = run_start + 1;
+        while (run_end < count && biquads_adjacent(channel, first_index + run_end - 1)) {
+            run_end++;
+        }
+
+        if (!write_biquad_run(dev, channel, first_index + run_start, run_end - run_start,
+                              &burst[run_start * BIQUAD_WIRE_BYTES], false)) {
             success = false;
         }
 
-        delay(DELAY_BATCH_PAGE_WRITE_MS);
+        run_start = run_end;
     }
 
     return success;
@@ -522,14 +913,14 @@ inline bool write_biquads_page(TAS5805M_I2C& dev, uint8_t page,
 inline bool write_channel_biquads_batched(esphome::i2c::I2CBus* bus, uint8_t address,
                                            int channel, const BiquadCoeffs coeffs[15]) {
     if (channel != 0 && channel != 1) {
-        ESP_LOGE("tas5805m_bq", "Batched write requires single channel (0 or 1)");
+        TAS5805M_BQ_LOGE("Batched write requires single channel (0 or 1)");
         return false;
     }
 
     TAS5805M_I2C dev(bus, address);
     const uint8_t* page_map = (channel == 0) ? PAGE_LEFT_BQ : PAGE_RIGHT_BQ;
 
-    ESP_LOGI("tas5805m_bq", "Batched write: channel %d", channel);
+    TAS5805M_BQ_LOGD("Batched write: channel %d", channel);
 
     bool success = true;
 
@@ -559,12 +950,43 @@ inline bool write_channel_biquads_batched(esphome::i2c::I2CBus* bus, uint8_t add
     return success;
 }
 
+/**
+ * True if both channels hold bit-identical coefficient sets
+ */
+inline bool channels_linked(const BiquadCoeffs left_coeffs[15], const BiquadCoeffs right_coeffs[15]) {
+    return left_coeffs == right_coeffs ||
+           memcmp(left_coeffs, right_coeffs, BIQUADS_PER_CHANNEL * sizeof(BiquadCoeffs)) == 0;
+}
+
+/**
+ * Pack both channels into wire form, converting a stereo-identical set once
+ *
+ * @return true if the channels were linked (wire[1] is a copy of wire[0])
+ */
+inline bool pack_channels(const BiquadCoeffs left_coeffs[15], const BiquadCoeffs right_coeffs[15],
+                          uint8_t (&wire)[2][BIQUADS_PER_CHANNEL * BIQUAD_WIRE_BYTES]) {
+    for (size_t i = 0; i < BIQUADS_PER_CHANNEL; i++) {
+        pack_biquad(left_coeffs[i], &wire[0][i * BIQUAD_WIRE_BYTES]);
+    }
+
+    if (channels_linked(left_coeffs, right_coeffs)) {
+        memcpy(wire[1], wire[0], sizeof(wire[0]));
+        return true;
+    }
+
+    for (size_t i = 0; i < BIQUADS_PER_CHANNEL; i++) {
+        pack_biquad(right_coeffs[i], &wire[1][i * BIQUAD_WIRE_BYTES]);
+    }
+    return false;
+}
+
 /**
  * Write all 30 biquads (both channels) efficiently
  *
  * Performance comparison:
  *   - Non-batched: ~150+ I2C transactions, 150ms+ delays
- *   - Batched: ~24 I2C transactions, ~30ms delays
+ *   - Batched (burst): ~20 I2C transactions, one 2ms book-select delay;
+ *     the rest is bus time for 8 x 81-byte bursts
  *
  * @param bus ESPHome I2C bus pointer
  * @param address I2C address
@@ -575,33 +997,255 @@ inline bool write_channel_biquads_batched(esphome::i2c::I2CBus* bus, uint8_t add
 inline bool write_all_biquads_batched(esphome::i2c::I2CBus* bus, uint8_t address,
                                        const BiquadCoeffs left_coeffs[15],
                                        const BiquadCoeffs right_coeffs[15]) {
-    ESP_LOGI("tas5805m_bq", "Batched write: all 30 biquads");
+    tas5805m_perf::ScopedProbe probe(tas5805m_perf::Probe::WRITE_ALL);
+    LogStopwatch<TAS5805M_LOG_LEVEL_INFO> timer;
+
+    // Stereo-identical sets are converted once
+    uint8_t wire[2][BIQUADS_PER_CHANNEL * BIQUAD_WIRE_BYTES];
+    bool linked = pack_channels(left_coeffs, right_coeffs, wire);
+
+    bool success = true;
+
+    {
+        // Both channel passes share one session (single return to book 0)
+        CoeffSession session(bus, address);
+        TAS5805M_I2C dev(bus, address);
+
+        // One burst per page, left pages then right pages
+        for (int ch = 0; ch < 2; ch++) {
+            for (size_t first = 0; first < BIQUADS_PER_CHANNEL; first += BIQUADS_PER_PAGE) {
+                size_t count = BIQUADS_PER_CHANNEL - first;
+                if (count > BIQUADS_PER_PAGE) count = BIQUADS_PER_PAGE;
+
+                if (!write_biquad_run(dev, ch, first, count, &wire[ch][first * BIQUAD_WIRE_BYTES], false)) {
+                    TAS5805M_BQ_LOGE("Failed to write %s channel biquads", ch == 0 ? "left" : "right");
+                    success = false;
+                }
+            }
+        }
+    }
+
+    TAS5805M_BQ_LOGI("Batched write: 30 biquads%s in %u ms", linked ? " (linked)" : "", timer.elapsed_ms());
+
+    if (!success) probe.fail();
+    return success;
+}
 
-    uint32_t start_time = millis();
+/**
+ * Delta-write packed coefficients for both channels in one sweep
+ *
+ * Left pages, then right pages, each visited once. The two pointers may be
+ * the same buffer (stereo-linked sets).
+ *
+ * @param left, right 15 * 20 bytes of packed coefficients each
+ * @return true on success
+ */
+inline bool write_both_channels_wire(esphome::i2c::I2CBus* bus, uint8_t address,
+                                     const uint8_t* left, const uint8_t* right) {
+    tas5805m_perf::ScopedProbe probe(tas5805m_perf::Probe::WRITE_ALL);
+    LogStopwatch<TAS5805M_LOG_LEVEL_INFO> timer;
 
+    TAS5805M_I2C dev(bus, address);
+    CoeffSession session(bus, address);  // One failure budget, one return to book 0 on scope exit
+    int runs = 0;
     bool success = true;
 
-    if (!write_channel_biquads_batched(bus, address, 0, left_coeffs)) {
-        ESP_LOGE("tas5805m_bq", "Failed to write left channel biquads");
+    if (!write_channel_delta(dev, 0, left, &runs)) {
+        TAS5805M_BQ_LOGE("Failed to write left channel biquads");
         success = false;
     }
 
-    if (!write_channel_biquads_batched(bus, address, 1, right_coeffs)) {
-        ESP_LOGE("tas5805m_bq", "Failed to write right channel biquads");
+    if (!write_channel_delta(dev, 1, right, &runs)) {
+        TAS5805M_BQ_LOGE("Failed to write right channel biquads");
         success = false;
     }
 
-    uint32_t elapsed = millis() - start_time;
-    ESP_LOGI("tas5805m_bq", "Batched write completed in %lu ms", elapsed);
+    if (runs == 0 && success) {
+        TAS5805M_BQ_LOGI("Delta write: DSP already up to date");
+        return true;
+    }
+
+    TAS5805M_BQ_LOGI("Delta write: %d run(s)%s in %u ms", runs,
+                     left == right ? " (linked)" : "", timer.elapsed_ms());
+
+    if (!success) probe.fail();
+    return success;
+}
+
+/**
+ * Delta-write an already packed 30-biquad wire image
+ *
+ * Same as write_all_biquads_delta, minus the float conversion: the bytes
+ * (9.23 big-endian, a1/a2 inverted, biquad order) are streamed as stored.
+ * Used for the precomputed profile images kept in NVS.
+ *
+ * @param wire [channel][15 * 20] packed coefficients
+ * @return true on success
+ */
+inline bool write_all_biquads_wire(esphome::i2c::I2CBus* bus, uint8_t address,
+                                   const uint8_t (&wire)[2][BIQUADS_PER_CHANNEL * BIQUAD_WIRE_BYTES]) {
+    return write_both_channels_wire(bus, address, wire[0], wire[1]);
+}
+
+/**
+ * Delta-write one packed 15-biquad image to both channels (stereo-linked)
+ *
+ * @param wire 15 * 20 packed coefficients, shared by left and right
+ */
+inline bool write_all_biquads_wire_linked(esphome::i2c::I2CBus* bus, uint8_t address,
+                                          const uint8_t (&wire)[BIQUADS_PER_CHANNEL * BIQUAD_WIRE_BYTES]) {
+    return write_both_channels_wire(bus, address, wire, wire);
+}
+
+/**
+ * Write all 30 biquads, sending only what differs from the coefficient shadow
+ *
+ * Both channels are packed up front and compared against the shadow; only
+ * differing biquads (grouped into per-page runs) go out on the bus. Applying
+ * a profile that is already in the DSP costs no I2C traffic at all, and a
+ * typical profile switch touches a handful of runs instead of all 8 pages.
+ *
+ * On a fresh boot the shadow is empty, so this degrades to a full write.
+ *
+ * @param bus ESPHome I2C bus pointer
+ * @param address I2C address
+ * @param left_coeffs Array of 15 biquad coefficient sets for left channel
+ * @param right_coeffs Array of 15 biquad coefficient sets for right channel
+ * @return true on success
+ */
+inline bool write_all_biquads_delta(esphome::i2c::I2CBus* bus, uint8_t address,
+                                    const BiquadCoeffs left_coeffs[15],
+                                    const BiquadCoeffs right_coeffs[15]) {
+    uint8_t wire[2][BIQUADS_PER_CHANNEL * BIQUAD_WIRE_BYTES];
+    pack_channels(left_coeffs, right_coeffs, wire);
+
+    return write_all_biquads_wire(bus, address, wire);
+}
+
+/**
+ * Write one 15-biquad set to both channels (stereo-linked)
+ *
+ * Packs once and delta-writes the same bytes to the left and right pages
+ * in a single sweep. Use when the correction is known to be stereo; the
+ * other full-set writers detect identical channels on their own.
+ */
+inline bool write_all_biquads_linked(esphome::i2c::I2CBus* bus, uint8_t address,
+                                     const BiquadCoeffs coeffs[15]) {
+    uint8_t wire[BIQUADS_PER_CHANNEL * BIQUAD_WIRE_BYTES];
+    for (size_t i = 0; i < BIQUADS_PER_CHANNEL; i++) {
+        pack_biquad(coeffs[i], &wire[i * BIQUAD_WIRE_BYTES]);
+    }
+
+    return write_all_biquads_wire_linked(bus, address, wire);
+}
+
+
+/**
+ * Number of biquads of one channel that differ from the shadow
+ */
+inline int count_channel_delta(int channel, const uint8_t* wire) {
+    int count = 0;
+    for (size_t i = 0; i < BIQUADS_PER_CHANNEL; i++) {
+        if (!g_coeff_shadow.matches(channel, i, &wire[i * BIQUAD_WIRE_BYTES])) count++;
+    }
+    return count;
+}
+
+/**
+ * Apply a full 30-biquad set (packed images) without audible intermediate states
+ *
+ * The TAS5805M applies each coefficient as soon as it is written, and its
+ * datasheet documents no coefficient swap/double-buffer mechanism for the
+ * biquad book, so a plain write lets the DSP run a mix of old and new
+ * filters. Instead the output is soft-muted (DEVICE_CTRL2 mute bit, which
+ * ramps the volume down rather than cutting it), the delta is written as
+ * bursts, and the mute bit is cleared again so the volume ramps back up.
+ *
+ * The unmute re-reads DEVICE_CTRL2 and clears only the mute bit, rather
+ * than writing back the byte read before the mute, so a play-state change
+ * made by the tas5805m driver in between is kept. Run it on the main loop
+ * (as the coefficient writer does) so the read and the write aren't split
+ * by a driver access. An output that was already muted stays muted and
+ * skips the ramp.
+ *
+ * The mute lasts one volume ramp plus the delta write (a few ms for a
+ * typical profile switch, ~20 ms for a full rewrite). If nothing differs
+ * from the shadow the output is not touched at all.
+ *
+ * @return true on success
+ */
+inline bool write_all_biquads_atomic_wire(esphome::i2c::I2CBus* bus, uint8_t address,
+                                          const uint8_t (&wire)[2][BIQUADS_PER_CHANNEL * BIQUAD_WIRE_BYTES]) {
+    int changed = count_channel_delta(0, wire[0]) + count_channel_delta(1, wire[1]);
+    if (changed == 0) {
+        TAS5805M_BQ_LOGI("Atomic write: DSP already up to date");
+        return true;
+    }
+
+    tas5805m_perf::ScopedProbe probe(tas5805m_perf::Probe::WRITE_ALL);
+    LogStopwatch<TAS5805M_LOG_LEVEL_INFO> timer;
+
+    TAS5805M_I2C dev(bus, address);
+    CoeffSession session(bus, address);
+
+    // Mute (ramped) unless the output already is
+    uint8_t ctrl2 = 0;
+    if (!dev.select_book_page(0x00, 0x00) || !dev.read_byte(REG_DEVICE_CTRL2, ctrl2)) {
+        TAS5805M_BQ_LOGE("Atomic write: failed to read DEVICE_CTRL2, coefficients not written");
+        return probe.fail();
+    }
+    const bool was_muted = (ctrl2 & DEVICE_CTRL2_MUTE) != 0;
+    if (!was_muted) {
+        if (!dev.write_byte(REG_DEVICE_CTRL2, ctrl2 | DEVICE_CTRL2_MUTE)) {
+            TAS5805M_BQ_LOGE("Atomic write: failed to mute, coefficients not written");
+            return probe.fail();
+        }
+        delay(DELAY_MUTE_RAMP_MS);
+    }
+
+    int runs = 0;
+    bool success = write_channel_delta(dev, 0, wire[0], &runs);
+    success = write_channel_delta(dev, 1, wire[1], &runs) && success;
+
+    // Unmute even after a failed write; a partial set is still better heard
+    // than a silent speaker, and the error is reported. Only the mute bit is
+    // ours to clear; the rest of the register is read fresh.
+    if (!was_muted) {
+        if (!dev.select_book_page(0x00, 0x00) || !dev.read_byte(REG_DEVICE_CTRL2, ctrl2) ||
+            !dev.write_byte(REG_DEVICE_CTRL2, ctrl2 & ~DEVICE_CTRL2_MUTE)) {
+            TAS5805M_BQ_LOGE("Atomic write: failed to unmute");
+            success = false;
+        }
+    }
+
+    if (!success) {
+        TAS5805M_BQ_LOGE("Atomic write: errors while writing biquads");
+    }
+
+    TAS5805M_BQ_LOGI("Atomic write: %d biquad(s) in %d run(s), %u ms%s",
+             changed, runs, timer.elapsed_ms(), was_muted ? " (output already muted)" : " muted");
 
+    if (!success) probe.fail();
     return success;
 }
 
+/**
+ * write_all_biquads_atomic_wire for float coefficient sets
+ */
+inline bool write_all_biquads_atomic(esphome::i2c::I2CBus* bus, uint8_t address,
+                                     const BiquadCoeffs left_coeffs[15],
+                                     const BiquadCoeffs right_coeffs[15]) {
+    uint8_t wire[2][BIQUADS_PER_CHANNEL * BIQUAD_WIRE_BYTES];
+    pack_channels(left_coeffs, right_coeffs, wire);
+
+    return write_all_biquads_atomic_wire(bus, address, wire);
+}
+
 /**
  * Reset all biquads to bypass using batched writes
  */
 inline bool reset_all_biquads_batched(esphome::i2c::I2CBus* bus, uint8_t address) {
-    ESP_LOGI("tas5805m_bq", "Batched reset: all 30 biquads to bypass");
+    TAS5805M_BQ_LOGD("Batched reset: all 30 biquads to bypass");
 
     // Create bypass coefficients for all 15 biquads
     BiquadCoeffs bypass[15];
@@ -611,85 +1255,273 @@ inline bool reset_all_biquads_batched(esphome::i2c::I2CBus* bus, uint8_t address
 }
 
 // =============================================================================
-// FILTER COEFFICIENT CALCULATORS
+// READBACK AND VERIFY
 // =============================================================================
 
 /**
- * Calculate and write a parametric EQ filter
- * @param out_coeffs Optional array of 5 floats to receive calculated coefficients [b0,b1,b2,a1,a2]
+ * Outcome of a verify pass over the 30 biquads
  */
-inline bool write_parametric_eq(esphome::i2c::I2CBus* bus, uint8_t address,
-                                int channel, int index,
-                                float frequency, float gain_db, float q,
-                                float fs = 48000.0f, float* out_coeffs = nullptr) {
+struct VerifyResult {
+    int checked = 0;             // Biquads compared against an expected value
+    int mismatched = 0;          // Of those, biquads whose DSP memory differed
+    int repaired = 0;            // Mismatched biquads rewritten successfully
+    int learned = 0;             // Biquads with nothing to compare, now known to the shadow
+    uint16_t mismatch_mask[2] = {0, 0};  // Bit i set = biquad i differed
+};
+
+/**
+ * Burst-read a run of adjacent biquads on one page in a single transaction
+ *
+ * The caller guarantees the run is adjacent (see biquads_adjacent).
+ *
+ * @param out count * 20 bytes, in wire form
+ */
+inline bool read_biquad_run(TAS5805M_I2C& dev, int channel, int first_index,
+                            size_t count, uint8_t* out) {
+    if (count == 0 || count * BIQUAD_WIRE_BYTES > MAX_BURST_BYTES) return false;
+
+    uint8_t page = biquad_page(channel, first_index);
+    if (!dev.select_book_page(BOOK_COEFF, page, false) ||
+        !dev.read_bytes(OFFSET_BQ[first_index], out, count * BIQUAD_WIRE_BYTES)) {
+        TAS5805M_BQ_LOGE("Failed to read BQ%d-%d on page 0x%02X",
+                         first_index, first_index + (int)count - 1, page);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Read back one channel page by page and compare it with the expected bytes
+ *
+ * Every biquad read is recorded in the shadow, so afterwards the shadow
+ * mirrors the chip. With repair set, mismatched biquads are rewritten while
+ * their page is still selected, grouped into adjacent runs.
+ *
+ * @param expected 15 * 20 bytes, or nullptr to compare against the shadow
+ *                 (slots the shadow doesn't know are only learned)
+ */
+inline bool verify_channel(TAS5805M_I2C& dev, int channel, const uint8_t* expected,
+                           bool repair, VerifyResult& result) {
+    bool success = true;
+    int index = 0;
 
-    const float A = std::pow(10.0f, gain_db / 40.0f);
-    const float omega = 2.0f * M_PI * frequency / fs;
-    const float sin_omega = std::sin(omega);
-    const float cos_omega = std::cos(omega);
-    const float alpha = sin_omega / (2.0f * q);
+    while (index < (int)BIQUADS_PER_CHANNEL) {
+        // One read covers all adjacent biquads on the page
+        int end = index + 1;
+        while (biquads_adjacent(channel, end - 1)) end++;
+        size_t count = end - index;
 
-    float b0 = 1.0f + alpha * A;
-    float b1 = -2.0f * cos_omega;
-    float b2 = 1.0f - alpha * A;
-    float a0 = 1.0f + alpha / A;
-    float a1 = -2.0f * cos_omega;
-    float a2 = 1.0f - alpha / A;
+        uint8_t chip[MAX_BURST_BYTES];
+        if (!read_biquad_run(dev, channel, index, count, chip)) {
+            for (int i = index; i < end; i++) g_coeff_shadow.invalidate(channel, i);
+            success = false;
+            index = end;
+            continue;
+        }
 
-    // Normalize by a0
-    b0 /= a0; b1 /= a0; b2 /= a0; a1 /= a0; a2 /= a0;
+        // Expected bytes are copied before the shadow is overwritten with the chip's
+        uint8_t want[MAX_BURST_BYTES];
+        uint16_t differs = 0;
+        for (int i = index; i < end; i++) {
+            const uint8_t* got = &chip[(i - index) * BIQUAD_WIRE_BYTES];
+            const uint8_t* exp = nullptr;
+            if (expected != nullptr) {
+                exp = &expected[i * BIQUAD_WIRE_BYTES];
+            } else if (g_coeff_shadow.is_known(channel, i)) {
+                exp = g_coeff_shadow.get(channel, i);
+            }
 
-    // Output coefficients if requested
-    if (out_coeffs != nullptr) {
-        out_coeffs[0] = b0;
-        out_coeffs[1] = b1;
-        out_coeffs[2] = b2;
-        out_coeffs[3] = a1;
-        out_coeffs[4] = a2;
+            if (exp == nullptr) {
+                result.learned++;
+            } else {
+                result.checked++;
+                if (memcmp(got, exp, BIQUAD_WIRE_BYTES) != 0) {
+                    memcpy(&want[(i - index) * BIQUAD_WIRE_BYTES], exp, BIQUAD_WIRE_BYTES);
+                    differs |= (1u << i);
+                    result.mismatched++;
+                    TAS5805M_BQ_LOGW("Verify: ch=%d BQ%d differs from expected", channel, i);
+                }
+            }
+            g_coeff_shadow.update(channel, i, got);
+        }
+        result.mismatch_mask[channel] |= differs;
+
+        // Rewrite runs of consecutive mismatches (the page is already selected)
+        for (int i = index; repair && i < end;) {
+            if (!(differs & (1u << i))) {
+                i++;
+                continue;
+            }
+            int run_end = i + 1;
+            while (run_end < end && (differs & (1u << run_end))) run_end++;
+
+            if (write_biquad_run(dev, channel, i, run_end - i,
+                                 &want[(i - index) * BIQUAD_WIRE_BYTES], false)) {
+                result.repaired += run_end - i;
+            } else {
+                success = false;
+            }
+            i = run_end;
+        }
+
+        index = end;
+    }
+
+    return success;
+}
+
+inline bool verify_biquads_impl(esphome::i2c::I2CBus* bus, uint8_t address,
+                                const uint8_t* expected_left, const uint8_t* expected_right,
+                                bool repair, VerifyResult* result_out) {
+    tas5805m_perf::ScopedProbe probe(tas5805m_perf::Probe::VERIFY);
+    LogStopwatch<TAS5805M_LOG_LEVEL_WARN> timer;  // Logged at WARN on a mismatch
+
+    VerifyResult result;
+    TAS5805M_I2C dev(bus, address);
+    bool success;
+    {
+        CoeffSession session(bus, address);
+        success = verify_channel(dev, 0, expected_left, repair, result);
+        success = verify_channel(dev, 1, expected_right, repair, result) && success;
     }
 
-    ESP_LOGI("tas5805m_bq", "PEQ: fc=%.1fHz gain=%.1fdB Q=%.2f", frequency, gain_db, q);
+    if (result.mismatched > 0) {
+        TAS5805M_BQ_LOGW("Verify: %d of %d biquad(s) differed, %d repaired (%u ms)",
+                         result.mismatched, result.checked, result.repaired, timer.elapsed_ms());
+    } else {
+        TAS5805M_BQ_LOGI("Verify: %d biquad(s) match (%u ms)", result.checked, timer.elapsed_ms());
+    }
 
-    return write_biquad(bus, address, channel, index, b0, b1, b2, a1, a2);
+    if (result_out != nullptr) *result_out = result;
+    if (!success) probe.fail();
+    return success;
 }
 
 /**
- * Calculate and write a low shelf filter
- * @param out_coeffs Optional array of 5 floats to receive calculated coefficients [b0,b1,b2,a1,a2]
+ * Check DSP memory against a packed 30-biquad image, rewriting what differs
+ *
+ * Costs 8 burst reads (one per channel page) plus one write per run of
+ * mismatched biquads; a clean chip costs no writes and no sleeps.
+ *
+ * @param expected [channel][15 * 20] packed coefficients
+ * @param repair Rewrite mismatched biquads (false = only report)
+ * @param result_out Optional per-biquad outcome
+ * @return true if every read (and repair write) succeeded
  */
-inline bool write_low_shelf(esphome::i2c::I2CBus* bus, uint8_t address,
-                            int channel, int index,
-                            float frequency, float gain_db, float slope = 1.0f,
-                            float fs = 48000.0f, float* out_coeffs = nullptr) {
+inline bool verify_all_biquads_wire(esphome::i2c::I2CBus* bus, uint8_t address,
+                                    const uint8_t (&expected)[2][BIQUADS_PER_CHANNEL * BIQUAD_WIRE_BYTES],
+                                    bool repair = true, VerifyResult* result_out = nullptr) {
+    return verify_biquads_impl(bus, address, expected[0], expected[1], repair, result_out);
+}
 
-    const float A = std::pow(10.0f, gain_db / 40.0f);
-    const float omega = 2.0f * M_PI * frequency / fs;
-    const float sin_omega = std::sin(omega);
-    const float cos_omega = std::cos(omega);
-    const float alpha = sin_omega / 2.0f * std::sqrt((A + 1.0f/A) * (1.0f/slope - 1.0f) + 2.0f);
-    const float two_sqrt_A_alpha = 2.0f * std::sqrt(A) * alpha;
+/**
+ * Check DSP memory against the coefficient shadow, rewriting what differs
+ *
+ * Catches anything that changed coefficient memory behind the shadow's back
+ * (a brown-out, the driver's graphic EQ, a lost write). Slots the shadow
+ * doesn't know are read into it, so the next delta write is exact.
+ */
+inline bool verify_coeff_shadow(esphome::i2c::I2CBus* bus, uint8_t address,
+                                bool repair = true, VerifyResult* result_out = nullptr) {
+    return verify_biquads_impl(bus, address, nullptr, nullptr, repair, result_out);
+}
+
+/**
+ * Read all 30 biquads out of DSP memory
+ *
+ * @param wire [channel][15 * 20] receives the packed coefficients
+ * @return true if all 8 page reads succeeded
+ */
+inline bool read_all_biquads_wire(esphome::i2c::I2CBus* bus, uint8_t address,
+                                  uint8_t (&wire)[2][BIQUADS_PER_CHANNEL * BIQUAD_WIRE_BYTES]) {
+    TAS5805M_I2C dev(bus, address);
+    CoeffSession session(bus, address);
+    bool success = true;
+
+    for (int ch = 0; ch < 2; ch++) {
+        int index = 0;
+        while (index < (int)BIQUADS_PER_CHANNEL) {
+            int end = index + 1;
+            while (biquads_adjacent(ch, end - 1)) end++;
+
+            uint8_t* out = &wire[ch][index * BIQUAD_WIRE_BYTES];
+            if (read_biquad_run(dev, ch, index, end - index, out)) {
+                for (int i = index; i < end; i++) {
+                    g_coeff_shadow.update(ch, i, &out[(i - index) * BIQUAD_WIRE_BYTES]);
+                }
+            } else {
+                success = false;
+            }
+            index = end;
+        }
+    }
+
+    return success;
+}
 
-    float b0 = A * ((A + 1.0f) - (A - 1.0f) * cos_omega + two_sqrt_A_alpha);
-    float b1 = 2.0f * A * ((A - 1.0f) - (A + 1.0f) * cos_omega);
-    float b2 = A * ((A + 1.0f) - (A - 1.0f) * cos_omega - two_sqrt_A_alpha);
-    float a0 = (A + 1.0f) + (A - 1.0f) * cos_omega + two_sqrt_A_alpha;
-    float a1 = -2.0f * ((A - 1.0f) + (A + 1.0f) * cos_omega);
-    float a2 = (A + 1.0f) + (A - 1.0f) * cos_omega - two_sqrt_A_alpha;
+/**
+ * Read all 30 biquads out of DSP memory as float coefficients
+ */
+inline bool read_all_biquads(esphome::i2c::I2CBus* bus, uint8_t address,
+                             BiquadCoeffs left_coeffs[15], BiquadCoeffs right_coeffs[15]) {
+    uint8_t wire[2][BIQUADS_PER_CHANNEL * BIQUAD_WIRE_BYTES];
+    if (!read_all_biquads_wire(bus, address, wire)) return false;
+
+    for (size_t i = 0; i < BIQUADS_PER_CHANNEL; i++) {
+        left_coeffs[i] = unpack_biquad(&wire[0][i * BIQUAD_WIRE_BYTES]);
+        right_coeffs[i] = unpack_biquad(&wire[1][i * BIQUAD_WIRE_BYTES]);
+    }
+    return true;
+}
 
-    b0 /= a0; b1 /= a0; b2 /= a0; a1 /= a0; a2 /= a0;
+// =============================================================================
+// FILTER PROGRAMMING
+// =============================================================================
 
+/**
+ * Copy a coefficient set to an optional [b0,b1,b2,a1,a2] array and write it
+ */
+inline bool write_coeffs(esphome::i2c::I2CBus* bus, uint8_t address,
+                         int channel, int index,
+                         const BiquadCoeffs& c, float* out_coeffs) {
     // Output coefficients if requested
     if (out_coeffs != nullptr) {
-        out_coeffs[0] = b0;
-        out_coeffs[1] = b1;
-        out_coeffs[2] = b2;
-        out_coeffs[3] = a1;
-        out_coeffs[4] = a2;
+        out_coeffs[0] = c.b0;
+        out_coeffs[1] = c.b1;
+        out_coeffs[2] = c.b2;
+        out_coeffs[3] = c.a1;
+        out_coeffs[4] = c.a2;
     }
 
-    ESP_LOGI("tas5805m_bq", "Low shelf: fc=%.1fHz gain=%.1fdB slope=%.2f", frequency, gain_db, slope);
+    return write_biquad(bus, address, channel, index, c.b0, c.b1, c.b2, c.a1, c.a2);
+}
+
+/**
+ * Calculate and write a parametric EQ filter
+ * @param out_coeffs Optional array of 5 floats to receive calculated coefficients [b0,b1,b2,a1,a2]
+ */
+inline bool write_parametric_eq(esphome::i2c::I2CBus* bus, uint8_t address,
+                                int channel, int index,
+                                float frequency, float gain_db, float q,
+                                float fs = 48000.0f, float* out_coeffs = nullptr) {
+    TAS5805M_BQ_LOGI("PEQ: fc=%.1fHz gain=%.1fdB Q=%.2f", frequency, gain_db, q);
+
+    return write_coeffs(bus, address, channel, index,
+                        calc_parametric_eq(frequency, gain_db, q, fs), out_coeffs);
+}
+
+/**
+ * Calculate and write a low shelf filter
+ * @param out_coeffs Optional array of 5 floats to receive calculated coefficients [b0,b1,b2,a1,a2]
+ */
+inline bool write_low_shelf(esphome::i2c::I2CBus* bus, uint8_t address,
+                            int channel, int index,
+                            float frequency, float gain_db, float slope = 1.0f,
+                            float fs = 48000.0f, float* out_coeffs = nullptr) {
+    TAS5805M_BQ_LOGI("Low shelf: fc=%.1fHz gain=%.1fdB slope=%.2f", frequency, gain_db, slope);
 
-    return write_biquad(bus, address, channel, index, b0, b1, b2, a1, a2);
+    return write_coeffs(bus, address, channel, index,
+                        calc_low_shelf(frequency, gain_db, slope, fs), out_coeffs);
 }
 
 /**
@@ -700,35 +1532,10 @@ inline bool write_high_shelf(esphome::i2c::I2CBus* bus, uint8_t address,
                              int channel, int index,
                              float frequency, float gain_db, float slope = 1.0f,
                              float fs = 48000.0f, float* out_coeffs = nullptr) {
+    TAS5805M_BQ_LOGI("High shelf: fc=%.1fHz gain=%.1fdB slope=%.2f", frequency, gain_db, slope);
 
-    const float A = std::pow(10.0f, gain_db / 40.0f);
-    const float omega = 2.0f * M_PI * frequency / fs;
-    const float sin_omega = std::sin(omega);
-    const float cos_omega = std::cos(omega);
-    const float alpha = sin_omega / 2.0f * std::sqrt((A + 1.0f/A) * (1.0f/slope - 1.0f) + 2.0f);
-    const float two_sqrt_A_alpha = 2.0f * std::sqrt(A) * alpha;
-
-    float b0 = A * ((A + 1.0f) + (A - 1.0f) * cos_omega + two_sqrt_A_alpha);
-    float b1 = -2.0f * A * ((A - 1.0f) + (A + 1.0f) * cos_omega);
-    float b2 = A * ((A + 1.0f) + (A - 1.0f) * cos_omega - two_sqrt_A_alpha);
-    float a0 = (A + 1.0f) - (A - 1.0f) * cos_omega + two_sqrt_A_alpha;
-    float a1 = 2.0f * ((A - 1.0f) - (A + 1.0f) * cos_omega);
-    float a2 = (A + 1.0f) - (A - 1.0f) * cos_omega - two_sqrt_A_alpha;
-
-    b0 /= a0; b1 /= a0; b2 /= a0; a1 /= a0; a2 /= a0;
-
-    // Output coefficients if requested
-    if (out_coeffs != nullptr) {
-        out_coeffs[0] = b0;
-        out_coeffs[1] = b1;
-        out_coeffs[2] = b2;
-        out_coeffs[3] = a1;
-        out_coeffs[4] = a2;
-    }
-
-    ESP_LOGI("tas5805m_bq", "High shelf: fc=%.1fHz gain=%.1fdB slope=%.2f", frequency, gain_db, slope);
-
-    return write_biquad(bus, address, channel, index, b0, b1, b2, a1, a2);
+    return write_coeffs(bus, address, channel, index,
+                        calc_high_shelf(frequency, gain_db, slope, fs), out_coeffs);
 }
 
 /**
@@ -739,33 +1546,10 @@ inline bool write_highpass(esphome::i2c::I2CBus* bus, uint8_t address,
                            int channel, int index,
                            float frequency, float q,
                            float fs = 48000.0f, float* out_coeffs = nullptr) {
+    TAS5805M_BQ_LOGI("High-pass: fc=%.1fHz Q=%.2f", frequency, q);
 
-    const float omega = 2.0f * M_PI * frequency / fs;
-    const float sin_omega = std::sin(omega);
-    const float cos_omega = std::cos(omega);
-    const float alpha = sin_omega / (2.0f * q);
-
-    float b0 = (1.0f + cos_omega) / 2.0f;
-    float b1 = -(1.0f + cos_omega);
-    float b2 = (1.0f + cos_omega) / 2.0f;
-    float a0 = 1.0f + alpha;
-    float a1 = -2.0f * cos_omega;
-    float a2 = 1.0f - alpha;
-
-    b0 /= a0; b1 /= a0; b2 /= a0; a1 /= a0; a2 /= a0;
-
-    // Output coefficients if requested
-    if (out_coeffs != nullptr) {
-        out_coeffs[0] = b0;
-        out_coeffs[1] = b1;
-        out_coeffs[2] = b2;
-        out_coeffs[3] = a1;
-        out_coeffs[4] = a2;
-    }
-
-    ESP_LOGI("tas5805m_bq", "High-pass: fc=%.1fHz Q=%.2f", frequency, q);
-
-    return write_biquad(bus, address, channel, index, b0, b1, b2, a1, a2);
+    return write_coeffs(bus, address, channel, index,
+                        calc_highpass(frequency, q, fs), out_coeffs);
 }
 
 /**
@@ -776,33 +1560,10 @@ inline bool write_lowpass(esphome::i2c::I2CBus* bus, uint8_t address,
                           int channel, int index,
                           float frequency, float q,
                           float fs = 48000.0f, float* out_coeffs = nullptr) {
+    TAS5805M_BQ_LOGI("Low-pass: fc=%.1fHz Q=%.2f", frequency, q);
 
-    const float omega = 2.0f * M_PI * frequency / fs;
-    const float sin_omega = std::sin(omega);
-    const float cos_omega = std::cos(omega);
-    const float alpha = sin_omega / (2.0f * q);
-
-    float b0 = (1.0f - cos_omega) / 2.0f;
-    float b1 = 1.0f - cos_omega;
-    float b2 = (1.0f - cos_omega) / 2.0f;
-    float a0 = 1.0f + alpha;
-    float a1 = -2.0f * cos_omega;
-    float a2 = 1.0f - alpha;
-
-    b0 /= a0; b1 /= a0; b2 /= a0; a1 /= a0; a2 /= a0;
-
-    // Output coefficients if requested
-    if (out_coeffs != nullptr) {
-        out_coeffs[0] = b0;
-        out_coeffs[1] = b1;
-        out_coeffs[2] = b2;
-        out_coeffs[3] = a1;
-        out_coeffs[4] = a2;
-    }
-
-    ESP_LOGI("tas5805m_bq", "Low-pass: fc=%.1fHz Q=%.2f", frequency, q);
-
-    return write_biquad(bus, address, channel, index, b0, b1, b2, a1, a2);
+    return write_coeffs(bus, address, channel, index,
+                        calc_lowpass(frequency, q, fs), out_coeffs);
 }
 
 /**
@@ -813,33 +1574,10 @@ inline bool write_notch(esphome::i2c::I2CBus* bus, uint8_t address,
                         int channel, int index,
                         float frequency, float q,
                         float fs = 48000.0f, float* out_coeffs = nullptr) {
+    TAS5805M_BQ_LOGI("Notch: fc=%.1fHz Q=%.2f", frequency, q);
 
-    const float omega = 2.0f * M_PI * frequency / fs;
-    const float sin_omega = std::sin(omega);
-    const float cos_omega = std::cos(omega);
-    const float alpha = sin_omega / (2.0f * q);
-
-    float b0 = 1.0f;
-    float b1 = -2.0f * cos_omega;
-    float b2 = 1.0f;
-    float a0 = 1.0f + alpha;
-    float a1 = -2.0f * cos_omega;
-    float a2 = 1.0f - alpha;
-
-    b0 /= a0; b1 /= a0; b2 /= a0; a1 /= a0; a2 /= a0;
-
-    // Output coefficients if requested
-    if (out_coeffs != nullptr) {
-        out_coeffs[0] = b0;
-        out_coeffs[1] = b1;
-        out_coeffs[2] = b2;
-        out_coeffs[3] = a1;
-        out_coeffs[4] = a2;
-    }
-
-    ESP_LOGI("tas5805m_bq", "Notch: fc=%.1fHz Q=%.2f", frequency, q);
-
-    return write_biquad(bus, address, channel, index, b0, b1, b2, a1, a2);
+    return write_coeffs(bus, address, channel, index,
+                        calc_notch(frequency, q, fs), out_coeffs);
 }
 
 }  // namespace tas5805m_biquad
@@ -0,0 +1,427 @@
+/**
+ * TAS5805M Biquad Cascade Optimizer
+ *
+ * Reduces a 15-biquad channel to fewer filters before it is written:
+ * - drops peaking EQ bands whose own effect stays below an audibility threshold
+ * - merges pairs of overlapping peaking EQs into one refitted peaking EQ
+ * - packs the remaining filters into the lowest slots, so the tail of the
+ *   cascade (the last coefficient pages) stays bypass
+ *
+ * Every step is checked against the response of the original cascade on a
+ * log-spaced 20 Hz - 20 kHz grid and only kept if the whole channel stays
+ * within max_error_db of it. Filters that aren't peaking EQs (shelves,
+ * high/low pass, notches) are never changed, only moved, so the check only
+ * needs the responses of the peaking EQs it touches.
+ *
+ * Pure math like tas5805m_dsp_math.h; no bus access. Uses a static
+ * workspace, so call it from the main loop only.
+ *
+ * Usage:
+ *   tas5805m_cascade::CascadeReport report;
+ *   tas5805m_cascade::optimize_channel(left, tas5805m_cascade::CascadeOptions(), &report);
+ */
+
+#pragma once
+
+#include "tas5805m_dsp_math.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace tas5805m_cascade {
+
+using tas5805m_biquad::BiquadCoeffs;
+using tas5805m_biquad::BIQUADS_PER_CHANNEL;
+
+// =============================================================================
+// CONSTANTS
+// =============================================================================
+
+constexpr size_t GRID_POINTS = 128;           // ~13 per octave over 20 Hz - 20 kHz
+constexpr float GRID_MIN_HZ = 20.0f;
+constexpr float GRID_MAX_HZ = 20000.0f;
+constexpr int MAX_FIT_ITERATIONS = 200;      // Coordinate-descent steps per merge candidate
+
+// Parameter range of a refitted peaking EQ (the services' validation limits)
+constexpr float FIT_MIN_GAIN_DB = -20.0f;
+constexpr float FIT_MAX_GAIN_DB = 20.0f;
+constexpr float FIT_MIN_Q = 0.1f;
+constexpr float FIT_MAX_Q = 20.0f;
+
+// =============================================================================
+// DATA STRUCTURES
+// =============================================================================
+
+/**
+ * Optimizer settings
+ */
+struct CascadeOptions {
+    float fs = 48000.0f;
+    float max_error_db = 0.5f;       // Allowed deviation from the original cascade, anywhere on the grid
+    float drop_below_db = 0.25f;     // Bands whose own peak stays below this are dropped
+    float merge_max_octaves = 1.0f;  // Peaking EQs further apart than this are never merged
+    bool pack = true;                // Move active filters to the lowest slots
+};
+
+/**
+ * What the optimizer did to one channel
+ */
+struct CascadeReport {
+    int before = 0;                  // Active (non-bypass) filters in
+    int after = 0;                   // Active filters out
+    int dropped = 0;
+    int merged = 0;                  // Pairs replaced by one filter
+    float max_error_db = 0.0f;       // Final deviation from the original response
+};
+
+/**
+ * Peaking EQ parameters recovered from coefficients
+ */
+struct PeqParams {
+    float frequency;
+    float gain_db;
+    float q;
+};
+
+// =============================================================================
+// FREQUENCY RESPONSE
+// =============================================================================
+
+/**
+ * Log-spaced evaluation grid
+ *
+ * Stores sin^2(w/2), cos^2(w/2) and sin(w) per point, the terms of the
+ * peaking EQ magnitude below.
+ */
+struct ResponseGrid {
+    float fs = 0.0f;
+    float sin2_half[GRID_POINTS];
+    float cos2_half[GRID_POINTS];
+    float sin_w[GRID_POINTS];
+
+    void build(float sample_rate) {
+        if (fs == sample_rate) return;
+        fs = sample_rate;
+        const float ratio = std::log(GRID_MAX_HZ / GRID_MIN_HZ) / (GRID_POINTS - 1);
+        for (size_t i = 0; i < GRID_POINTS; i++) {
+            float f = GRID_MIN_HZ * std::exp(ratio * i);
+            float half = static_cast<float>(M_PI) * f / fs;
+            sin2_half[i] = std::sin(half) * std::sin(half);
+            cos2_half[i] = std::cos(half) * std::cos(half);
+            sin_w[i] = std::sin(2.0f * half);
+        }
+    }
+};
+
+/**
+ * Peaking EQ magnitude response in dB, evaluated from its parameters
+ *
+ * For the RBJ peaking EQ, |B|^2 = 4 (D^2 + (alpha A sin w)^2) and
+ * |A|^2 = 4 (D^2 + (alpha/A sin w)^2) with D = cos w - cos w0, written as
+ * 2 (sin^2(w/2) cos^2(w0/2) - cos^2(w/2) sin^2(w0/2)) so it stays accurate
+ * in float at low frequencies. Expanding the coefficients directly loses
+ * the response of a high-Q bass band to cancellation.
+ */
+inline void peq_response_db(const ResponseGrid& grid, const PeqParams& p, float* out) {
+    const float half0 = static_cast<float>(M_PI) * p.frequency / grid.fs;
+    const float s0 = std::sin(half0) * std::sin(half0);
+    const float c0 = std::cos(half0) * std::cos(half0);
+    const float A = std::pow(10.0f, p.gain_db / 40.0f);
+    const float alpha = std::sin(2.0f * half0) / (2.0f * p.q);
+    const float num_k = alpha * A;
+    const float den_k = alpha / A;
+
+    for (size_t i = 0; i < GRID_POINTS; i++) {
+        float d = 2.0f * (grid.sin2_half[i] * c0 - grid.cos2_half[i] * s0);
+        float d2 = d * d;
+        float num = d2 + (num_k * grid.sin_w[i]) * (num_k * grid.sin_w[i]);
+        float den = d2 + (den_k * grid.sin_w[i]) * (den_k * grid.sin_w[i]);
+        out[i] = (den > 0.0f) ? 10.0f * std::log10(num / den) : 0.0f;
+    }
+}
+
+// =============================================================================
+// PEAKING EQ RECOVERY
+// =============================================================================
+
+/**
+ * Recover frequency/gain/Q if c is an RBJ peaking EQ
+ *
+ * A peaking EQ has b1 == a1 and b0 + b2 == 1 + a2; with d = 1 + alpha/A
+ * the cookbook terms follow as cos(w0) = -a1 d / 2, alpha*A = b0 d - 1,
+ * alpha/A = d - 1.
+ *
+ * @return false for any other filter type (and for bypass)
+ */
+inline bool peq_params(const BiquadCoeffs& c, float fs, PeqParams& out) {
+    constexpr float TOLERANCE = 2e-6f;  // A few float ULPs; shelves miss by ~1e-5
+    if (c.is_bypass()) return false;
+    if (std::fabs(c.b1 - c.a1) > TOLERANCE) return false;
+    if (std::fabs(c.b0 + c.b2 - 1.0f - c.a2) > TOLERANCE) return false;
+
+    const float d = 2.0f / (1.0f + c.a2);
+    const float cos_w0 = -c.a1 * d / 2.0f;
+    const float alpha_a = c.b0 * d - 1.0f;
+    const float alpha_over_a = d - 1.0f;
+    if (cos_w0 <= -1.0f || cos_w0 >= 1.0f || alpha_a <= 0.0f || alpha_over_a <= 0.0f) return false;
+
+    const float w0 = std::acos(cos_w0);
+    const float A = std::sqrt(alpha_a / alpha_over_a);
+    const float alpha = std::sqrt(alpha_a * alpha_over_a);
+
+    out.frequency = w0 * fs / (2.0f * static_cast<float>(M_PI));
+    out.gain_db = 40.0f * std::log10(A);
+    out.q = std::sin(w0) / (2.0f * alpha);
+    return true;
+}
+
+/**
+ * Design a peaking EQ without going through the trig cache
+ */
+inline BiquadCoeffs design_peq(const PeqParams& p, float fs) {
+    const float w0 = 2.0f * static_cast<float>(M_PI) * p.frequency / fs;
+    return tas5805m_biquad::calc_parametric_eq_omega(std::sin(w0), std::cos(w0), p.gain_db, p.q);
+}
+
+// =============================================================================
+// OPTIMIZER
+// =============================================================================
+
+enum class PairFit : uint8_t { UNKNOWN, FITS, NO_FIT };
+
+/**
+ * Scratch buffers for one optimize_channel call (~6 KB, kept off the stack)
+ */
+struct CascadeWorkspace {
+    ResponseGrid grid;
+    float error[GRID_POINTS];      // Optimized minus original response, in dB
+    float target[GRID_POINTS];     // Response a merge candidate must reproduce
+    float resp_a[GRID_POINTS];
+    float resp_b[GRID_POINTS];
+    float resp_m[GRID_POINTS];
+
+    // Merge fits per pair (a < b), reused across merge passes until a or b changes
+    PairFit pair_state[BIQUADS_PER_CHANNEL][BIQUADS_PER_CHANNEL];
+    PeqParams pair_fit[BIQUADS_PER_CHANNEL][BIQUADS_PER_CHANNEL];
+};
+
+static CascadeWorkspace g_cascade_workspace;
+
+/**
+ * Worst |error - removed_a - removed_b + added| over the grid, i.e. the
+ * channel's deviation from the original if the change were made
+ *
+ * @param removed_a, removed_b Responses taken out of the cascade (nullptr = none)
+ * @param added Response put in (nullptr = none)
+ */
+inline float cascade_error_db(const CascadeWorkspace& ws, const float* removed_a,
+                              const float* removed_b, const float* added) {
+    float worst = 0.0f;
+    for (size_t i = 0; i < GRID_POINTS; i++) {
+        float v = ws.error[i];
+        if (removed_a != nullptr) v -= removed_a[i];
+        if (removed_b != nullptr) v -= removed_b[i];
+        if (added != nullptr) v += added[i];
+        float e = std::fabs(v);
+        if (e > worst) worst = e;
+    }
+    return worst;
+}
+
+/**
+ * Fit one peaking EQ to ws.target by coordinate descent on
+ * (log2 frequency, gain, log2 Q), minimizing the worst-case dB error
+ *
+ * @param p Starting point in, best fit out
+ * @return worst-case error of the fit against the target
+ */
+inline float fit_peq(CascadeWorkspace& ws, PeqParams& p) {
+    auto error_of = [&](const PeqParams& candidate) {
+        peq_response_db(ws.grid, candidate, ws.resp_m);
+        float worst = 0.0f;
+        for (size_t i = 0; i < GRID_POINTS; i++) {
+            float e = std::fabs(ws.resp_m[i] - ws.target[i]);
+            if (e > worst) worst = e;
+        }
+        return worst;
+    };
+    auto clamp = [](float v, float lo, float hi) { return v < lo ? lo : (v > hi ? hi : v); };
+
+    const float max_frequency = ws.grid.fs * 0.45f;
+    float best = error_of(p);
+    float step[3] = {0.25f, 1.0f, 0.25f};  // Octaves, dB, log2 Q
+
+    for (int it = 0; it < MAX_FIT_ITERATIONS && step[1] > 0.01f; it++) {
+        bool improved = false;
+        for (int axis = 0; axis < 3; axis++) {
+            for (int sign = -1; sign <= 1; sign += 2) {
+                PeqParams c = p;
+                if (axis == 0) {
+                    c.frequency = clamp(p.frequency * std::exp2(sign * step[0]), GRID_MIN_HZ, max_frequency);
+                } else if (axis == 1) {
+                    c.gain_db = clamp(p.gain_db + sign * step[1], FIT_MIN_GAIN_DB, FIT_MAX_GAIN_DB);
+                } else {
+                    c.q = clamp(p.q * std::exp2(sign * step[2]), FIT_MIN_Q, FIT_MAX_Q);
+                }
+                float e = error_of(c);
+                if (e < best) {
+                    best = e;
+                    p = c;
+                    improved = true;
+                }
+            }
+        }
+        if (!improved) {
+            for (float& s : step) s *= 0.5f;
+        }
+    }
+    return best;
+}
+
+/**
+ * Optimize one channel in place
+ *
+ * Greedy: drop every negligible band the error budget allows, then keep
+ * merging the pair of nearby peaking EQs whose refit fits best, until no
+ * merge stays within budget. Finally packs the active filters to the front
+ * (cascade order doesn't change the response).
+ *
+ * @param channel 15 biquads, rewritten in place
+ * @return number of active filters after optimization
+ */
+inline int optimize_channel(BiquadCoeffs channel[15], const CascadeOptions& options,
+                            CascadeReport* report_out = nullptr) {
+    CascadeWorkspace& ws = g_cascade_workspace;
+    ws.grid.build(options.fs);
+    for (size_t i = 0; i < GRID_POINTS; i++) ws.error[i] = 0.0f;
+
+    CascadeReport report;
+    PeqParams params[BIQUADS_PER_CHANNEL];
+    bool is_peq[BIQUADS_PER_CHANNEL];
+    for (size_t k = 0; k < BIQUADS_PER_CHANNEL; k++) {
+        if (!channel[k].is_bypass()) report.before++;
+        is_peq[k] = peq_params(channel[k], options.fs, params[k]);
+    }
+
+    // 1. Drop bands that barely do anything, while the budget allows
+    for (size_t k = 0; k < BIQUADS_PER_CHANNEL; k++) {
+        if (!is_peq[k]) continue;
+        peq_response_db(ws.grid, params[k], ws.resp_a);
+
+        float peak = 0.0f;
+        for (size_t i = 0; i < GRID_POINTS; i++) {
+            if (std::fabs(ws.resp_a[i]) > peak) peak = std::fabs(ws.resp_a[i]);
+        }
+        if (peak >= options.drop_below_db) continue;
+        if (cascade_error_db(ws, ws.resp_a, nullptr, nullptr) > options.max_error_db) continue;
+
+        for (size_t i = 0; i < GRID_POINTS; i++) ws.error[i] -= ws.resp_a[i];
+        channel[k] = BiquadCoeffs();
+        is_peq[k] = false;
+        report.dropped++;
+    }
+
+    // 2. Merge overlapping peaking EQs, best fit first
+    for (size_t a = 0; a < BIQUADS_PER_CHANNEL; a++) {
+        for (size_t b = 0; b < BIQUADS_PER_CHANNEL; b++) ws.pair_state[a][b] = PairFit::UNKNOWN;
+    }
+    while (true) {
+        int best_a = -1, best_b = -1;
+        float best_error = options.max_error_db;
+        PeqParams best_fit{};
+
+        for (size_t a = 0; a < BIQUADS_PER_CHANNEL; a++) {
+            if (!is_peq[a]) continue;
+            const PeqParams& pa = params[a];
+
+            for (size_t b = a + 1; b < BIQUADS_PER_CHANNEL; b++) {
+                if (!is_peq[b]) continue;
+                const PeqParams& pb = params[b];
+                if (std::fabs(std::log2(pb.frequency / pa.frequency)) > options.merge_max_octaves) continue;
+
+                if (ws.pair_state[a][b] == PairFit::NO_FIT) continue;
+
+                // Target: what the pair does together
+                peq_response_db(ws.grid, pa, ws.resp_a);
+                peq_response_db(ws.grid, pb, ws.resp_b);
+
+                if (ws.pair_state[a][b] == PairFit::UNKNOWN) {
+                    for (size_t i = 0; i < GRID_POINTS; i++) ws.target[i] = ws.resp_a[i] + ws.resp_b[i];
+
+                    // Start from the gain-weighted centre and the summed gain
+                    float wa = std::fabs(pa.gain_db), wb = std::fabs(pb.gain_db);
+                    PeqParams fit;
+                    fit.frequency = std::exp2((wa * std::log2(pa.frequency) + wb * std::log2(pb.frequency)) /
+                                              (wa + wb + 1e-6f));
+                    fit.gain_db = pa.gain_db + pb.gain_db;
+                    fit.q = std::sqrt(pa.q * pb.q);
+                    if (fit.gain_db < FIT_MIN_GAIN_DB) fit.gain_db = FIT_MIN_GAIN_DB;
+                    if (fit.gain_db > FIT_MAX_GAIN_DB) fit.gain_db = FIT_MAX_GAIN_DB;
+
+                    bool fits = fit_peq(ws, fit) <= options.max_error_db;
+                    ws.pair_state[a][b] = fits ? PairFit::FITS : PairFit::NO_FIT;
+                    ws.pair_fit[a][b] = fit;
+                    if (!fits) continue;
+                }
+                const PeqParams& fit = ws.pair_fit[a][b];
+
+                // The budget is for the whole channel, not just the pair
+                peq_response_db(ws.grid, fit, ws.resp_m);
+                float error = cascade_error_db(ws, ws.resp_a, ws.resp_b, ws.resp_m);
+                if (error <= best_error) {
+                    best_error = error;
+                    best_a = static_cast<int>(a);
+                    best_b = static_cast<int>(b);
+                    best_fit = fit;
+                }
+            }
+        }
+
+        if (best_a < 0) break;
+
+        peq_response_db(ws.grid, params[best_a], ws.resp_a);
+        peq_response_db(ws.grid, params[best_b], ws.resp_b);
+        peq_response_db(ws.grid, best_fit, ws.resp_m);
+        for (size_t i = 0; i < GRID_POINTS; i++) {
+            ws.error[i] += ws.resp_m[i] - ws.resp_a[i] - ws.resp_b[i];
+        }
+        channel[best_a] = design_peq(best_fit, options.fs);
+        params[best_a] = best_fit;
+        channel[best_b] = BiquadCoeffs();
+        is_peq[best_b] = false;
+        report.merged++;
+
+        // Pairs with the merged filter need a new fit
+        for (size_t k = 0; k < BIQUADS_PER_CHANNEL; k++) {
+            ws.pair_state[k][best_a] = PairFit::UNKNOWN;
+            ws.pair_state[best_a][k] = PairFit::UNKNOWN;
+        }
+    }
+
+    // 3. Pack active filters to the front, keeping their order
+    if (options.pack) {
+        size_t next = 0;
+        for (size_t k = 0; k < BIQUADS_PER_CHANNEL; k++) {
+            if (channel[k].is_bypass()) continue;
+            if (k != next) {
+                channel[next] = channel[k];
+                channel[k] = BiquadCoeffs();
+            }
+            next++;
+        }
+    }
+
+    for (size_t k = 0; k < BIQUADS_PER_CHANNEL; k++) {
+        if (!channel[k].is_bypass()) report.after++;
+    }
+    report.max_error_db = cascade_error_db(ws, nullptr, nullptr, nullptr);
+
+    TAS5805M_BQ_LOGI("Cascade: %d -> %d filter(s) (%d dropped, %d merged, max error %.2f dB)",
+                     report.before, report.after, report.dropped, report.merged,
+                     report.max_error_db);
+
+    if (report_out != nullptr) *report_out = report;
+    return report.after;
+}
+
+}  // namespace tas5805m_cascade
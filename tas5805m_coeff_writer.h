@@ -0,0 +1,673 @@
+/**
+ * TAS5805M Deferred Coefficient Writer for ESPHome
+ *
+ * Takes DSP programming out of the service calls. Producers (API services,
+ * scripts) enqueue commands into a bounded queue and return immediately;
+ * the writer executes them from loop(), one command per main-loop pass.
+ * Progress and results are exposed through counters for status sensors.
+ *
+ * Usage in ESPHome lambda:
+ *   #include "tas5805m_coeff_writer.h"
+ *   tas5805m_writer::coeff_writer().start(id(i2c_bus), id(tas5805m_addr));
+ *   tas5805m_writer::coeff_writer().write_biquad(2, 0, coeffs);
+ *
+ *   interval:
+ *     - interval: 10ms
+ *       then:
+ *         - lambda: tas5805m_writer::coeff_writer().loop();
+ *
+ * Until start() is called (e.g. during boot) every command runs synchronously
+ * on the caller, so the same API works before and after the queue is up.
+ *
+ * Bus access stays on the main loop on purpose. The tas5805m driver also
+ * runs there: it polls every second and writes volume, mute and its graphic
+ * EQ in book 0. Each command is a self-contained session that leaves the
+ * chip at book 0, page 0 when it finishes, and nothing else on the main
+ * loop runs in between, so the driver never finds the chip in the
+ * coefficient book. A separate task would need a lock the driver doesn't
+ * take. Only the I2C work of the one command runs in a pass; the
+ * coefficient math happens in the producers.
+ *
+ * Single-biquad writes are coalesced: each (channel, index) slot holds only
+ * the newest pending coefficient set, and the writer flushes all dirty slots
+ * once the oldest has waited the latency budget. A slider fired dozens of
+ * times per second thus costs one write per slot per window.
+ *
+ * Once started, all coefficient writes from this package should go through
+ * the writer: the tas5805m_biquad helpers share the register cursor and the
+ * coefficient shadow, which the writer relies on.
+ *
+ * Profile applies can also be scheduled for a wall-clock time (apply_wire_at):
+ * the image is staged right away and the writer holds it until the commit
+ * time, so units in a Sendspin group switch filters together. Each queued
+ * apply keeps its own staged image, and single-biquad flushes behind a
+ * scheduled apply go ahead of it (folded into its image) instead of waiting.
+ *
+ * Slots can be pinned (pin_biquad), e.g. by loudness compensation: a pinned
+ * slot keeps its coefficients through profile applies, resets and
+ * single-biquad writes, which write the pinned bytes in its place, until it
+ * is unpinned.
+ */
+
+#pragma once
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+#include "tas5805m_biquad_i2c.h"
+#include <sys/time.h>
+#include <atomic>
+#include <cstring>
+
+namespace tas5805m_writer {
+
+static const char *const TAG = "tas5805m_writer";
+
+// =============================================================================
+// CONSTANTS
+// =============================================================================
+
+constexpr size_t QUEUE_DEPTH = 16;            // Pending commands before producers are rejected
+constexpr size_t STAGED_DEPTH = 4;            // Staged profile images (queued applies) before more are rejected
+constexpr uint32_t COALESCE_WINDOW_MS = 20;   // Default latency budget for biquad writes
+constexpr int64_t MAX_COMMIT_LEAD_MS = 10000; // Furthest a scheduled apply may lie ahead (it holds back
+                                              // profile and verify commands queued behind it)
+constexpr uint32_t COMMIT_SPIN_US = 20000;    // Longer than one main-loop pass (16 ms): the pass before
+                                              // a commit time busy-waits for it
+constexpr int64_t MIN_SYNCED_EPOCH_MS = 1577836800000LL;  // 2020-01-01; earlier means no SNTP time yet
+
+// =============================================================================
+// DATA STRUCTURES
+// =============================================================================
+
+enum class CommandType : uint8_t {
+    FLUSH_SLOTS,    // Write all dirty biquad slots
+    APPLY_PROFILE,  // Apply the staged 30-biquad set (muted swap or delta)
+    RESET_ALL,      // All 30 biquads to bypass
+    VERIFY,         // Read back DSP memory, compare with the shadow, repair mismatches
+};
+
+/**
+ * One queued command (payloads live in the staging slots, not the queue)
+ */
+struct Command {
+    CommandType type;
+    uint32_t seq;
+    uint32_t generation;   // FLUSH_SLOTS: stale if a full apply was queued since
+    uint32_t queued_ms;
+    uint64_t due_us;       // APPLY_PROFILE: monotonic commit time (0 = as soon as possible)
+    uint8_t image;         // APPLY_PROFILE: index into the staged images
+    bool repair;           // VERIFY: rewrite mismatched biquads
+};
+
+/**
+ * Writer counters, read by the status sensors
+ */
+struct WriterStats {
+    std::atomic<uint32_t> queued{0};       // Commands accepted
+    std::atomic<uint32_t> completed{0};    // Commands executed successfully
+    std::atomic<uint32_t> failed{0};       // Commands whose I2C writes failed
+    std::atomic<uint32_t> rejected{0};     // Commands dropped because the queue was full
+    std::atomic<uint32_t> coalesced{0};    // Biquad updates superseded before being written
+    std::atomic<uint32_t> last_seq{0};     // Sequence number of the last finished command
+    std::atomic<bool> last_ok{true};       // Result of the last finished command
+    std::atomic<uint32_t> last_duration_ms{0};
+    std::atomic<uint32_t> verify_mismatches{0};  // Biquads the last verify found differing
+    std::atomic<uint32_t> verify_repairs{0};     // Biquads the last verify rewrote
+    std::atomic<uint32_t> scheduled{0};          // Applies committed at a scheduled time
+    std::atomic<int32_t> last_commit_skew_us{0}; // Start of the last scheduled apply minus its commit time
+};
+
+/**
+ * Wall-clock time in ms since the Unix epoch (set by SNTP)
+ */
+inline int64_t epoch_ms() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return static_cast<int64_t>(tv.tv_sec) * 1000 + tv.tv_usec / 1000;
+}
+
+// =============================================================================
+// COEFFICIENT WRITER
+// =============================================================================
+
+class CoeffWriter {
+public:
+    /**
+     * Switch from inline execution to the queue serviced by loop()
+     * @return true (also if already started)
+     */
+    bool start(esphome::i2c::I2CBus* bus, uint8_t address) {
+        if (running_) return true;
+
+        bus_ = bus;
+        address_ = address;
+        running_ = true;
+
+        ESP_LOGI(TAG, "Coefficient writer started (queue depth %d)", (int)QUEUE_DEPTH);
+        return true;
+    }
+
+    bool is_running() const { return running_; }
+
+    /**
+     * Execute the next due command (main loop, once per pass)
+     *
+     * Returns without touching the bus while the head command waits for its
+     * coalescing window or its commit time. While a scheduled apply waits,
+     * the flush right behind it may run first.
+     */
+    void loop() {
+        if (!running_ || count_ == 0) return;
+
+        size_t pos = 0;
+        const Command& head = queue_[head_];
+        if (head.due_us != 0 && tas5805m_perf::now_us() + COMMIT_SPIN_US < head.due_us) {
+            // A later pass gets closer; volume follows and slider moves needn't wait
+            pos = flush_behind_head();
+            if (pos == 0) return;
+        }
+
+        const Command& next = queue_[(head_ + pos) % QUEUE_DEPTH];
+
+        // Let slider bursts collect in the slots until the budget expires
+        // (a flush superseded by a full apply is dropped right away)
+        if (next.type == CommandType::FLUSH_SLOTS && next.generation == generation_ &&
+            esphome::millis() - next.queued_ms < coalesce_window_ms_) {
+            return;
+        }
+
+        if (next.due_us != 0) wait_until(next.due_us);
+
+        Command cmd = take(pos);
+
+        uint32_t start = esphome::millis();
+        bool ok = execute(cmd);
+        finish(cmd, ok, esphome::millis() - start);
+    }
+
+    /**
+     * Latency budget for coalesced biquad writes (0 = flush on the next pass)
+     */
+    void set_coalesce_window_ms(uint32_t window_ms) { coalesce_window_ms_ = window_ms; }
+
+    /**
+     * Apply profiles atomically (soft mute around the write, default) or as a
+     * plain delta write where the DSP briefly runs mixed filters
+     */
+    void set_atomic_apply(bool atomic) { atomic_apply_ = atomic; }
+
+    /**
+     * Queue a single biquad write
+     *
+     * Replaces any not-yet-written update for the same slot. The returned
+     * sequence number is that of the flush which will carry the update.
+     *
+     * @param channel 0=left, 1=right, 2=both
+     * @return sequence number, or 0 if rejected (or, before start(), if the write failed)
+     */
+    uint32_t write_biquad(int channel, int index, const tas5805m_biquad::BiquadCoeffs& coeffs) {
+        uint8_t wire[tas5805m_biquad::BIQUAD_WIRE_BYTES];
+        tas5805m_biquad::pack_biquad(coeffs, wire);
+        return write_biquad_wire(channel, index, wire);
+    }
+
+    /**
+     * Queue a single biquad write already in wire form (20 bytes)
+     *
+     * Same coalescing as write_biquad, without the packing. A pinned slot
+     * gets its pinned bytes instead.
+     */
+    uint32_t write_biquad_wire(int channel, int index, const uint8_t* wire) {
+        if (!tas5805m_biquad::validate_channel(channel) ||
+            !tas5805m_biquad::validate_index(index)) {
+            return 0;
+        }
+
+        const uint16_t bit = 1u << index;
+
+        // Not started yet (boot, host tests): write inline
+        if (!is_running()) {
+            stats_.queued++;
+            Command cmd{};
+            cmd.seq = take_seq();
+            bool ok;
+            if (channel == 2 && !((pinned_[0] | pinned_[1]) & bit)) {
+                ok = tas5805m_biquad::write_biquad_wire(bus_, address_, 2, index, wire);
+            } else {
+                ok = true;
+                for (int ch = 0; ch < 2; ch++) {
+                    if (channel != 2 && channel != ch) continue;
+                    if (!tas5805m_biquad::write_biquad_wire(bus_, address_, ch, index,
+                                                            slot_wire(ch, index, wire))) {
+                        ok = false;
+                    }
+                }
+            }
+            finish(cmd, ok, 0);
+            return ok ? cmd.seq : 0;
+        }
+
+        for (int ch = 0; ch < 2; ch++) {
+            if (channel != 2 && channel != ch) continue;
+            if (dirty_[ch] & bit) stats_.coalesced++;
+            memcpy(&slots_[ch][index * tas5805m_biquad::BIQUAD_WIRE_BYTES], slot_wire(ch, index, wire),
+                   tas5805m_biquad::BIQUAD_WIRE_BYTES);
+            dirty_[ch] |= bit;
+        }
+
+        // One flush per window carries every update made before it runs
+        uint32_t seq = flush_seq_;
+        if (seq == 0) {
+            Command cmd{};
+            cmd.type = CommandType::FLUSH_SLOTS;
+            cmd.generation = generation_;
+            seq = submit(cmd);
+            flush_seq_ = seq;
+            if (seq == 0) {
+                // Queue full: drop the updates rather than leave them orphaned
+                dirty_[0] = dirty_[1] = 0;
+            }
+        }
+
+        return seq;
+    }
+
+    /**
+     * Pin a biquad slot to the given coefficients and queue their write
+     *
+     * Until unpinned, profile applies, resets and single-biquad writes put
+     * these bytes into the slot instead of their own.
+     *
+     * @param channel 0=left, 1=right, 2=both
+     * @return sequence number of the write, or 0 if rejected
+     */
+    uint32_t pin_biquad(int channel, int index, const uint8_t* wire) {
+        if (!tas5805m_biquad::validate_channel(channel) ||
+            !tas5805m_biquad::validate_index(index)) {
+            return 0;
+        }
+
+        for (int ch = 0; ch < 2; ch++) {
+            if (channel != 2 && channel != ch) continue;
+            memcpy(&pinned_wire_[ch][index * tas5805m_biquad::BIQUAD_WIRE_BYTES], wire,
+                   tas5805m_biquad::BIQUAD_WIRE_BYTES);
+            pinned_[ch] |= 1u << index;
+        }
+
+        return write_biquad_wire(channel, index, wire);
+    }
+
+    /**
+     * Release a pinned slot; it keeps its coefficients until the next write
+     */
+    void unpin_biquad(int channel, int index) {
+        if (!tas5805m_biquad::validate_channel(channel) ||
+            !tas5805m_biquad::validate_index(index)) {
+            return;
+        }
+
+        for (int ch = 0; ch < 2; ch++) {
+            if (channel != 2 && channel != ch) continue;
+            pinned_[ch] &= ~(1u << index);
+        }
+    }
+
+    /**
+     * Stage a full profile and queue its application
+     *
+     * Back-to-back applies before the writer gets to them share one staged
+     * image and the newest wins (the delta write makes repeated applies of
+     * the same set free). A scheduled apply keeps its own image.
+     */
+    uint32_t apply_profile(const tas5805m_biquad::BiquadCoeffs left[15],
+                           const tas5805m_biquad::BiquadCoeffs right[15]) {
+        uint8_t wire[2][15 * tas5805m_biquad::BIQUAD_WIRE_BYTES];
+        tas5805m_biquad::pack_channels(left, right, wire);
+        return apply_wire(wire);
+    }
+
+    /**
+     * Stage a full profile already in wire form (e.g. from the rate image
+     * cache) and queue its application
+     */
+    uint32_t apply_wire(const uint8_t (&wire)[2][15 * tas5805m_biquad::BIQUAD_WIRE_BYTES]) {
+        // An unscheduled apply still at the tail takes the newer image
+        if (count_ > 0) {
+            const Command& tail = queue_[(head_ + count_ - 1) % QUEUE_DEPTH];
+            if (tail.type == CommandType::APPLY_PROFILE && tail.due_us == 0) {
+                memcpy(staged_wire_[tail.image], wire, sizeof(staged_wire_[0]));
+                supersede_slots();
+                return tail.seq;
+            }
+        }
+
+        return stage_apply(wire, 0);
+    }
+
+    /**
+     * Stage a full profile now and apply it at a wall-clock time
+     *
+     * For group switches: every unit gets the same commit time and starts
+     * its write at that moment by its own SNTP clock, instead of one after
+     * the other as the calls arrive. The commit time is converted to the
+     * monotonic clock here, so SNTP adjustments while waiting don't move it.
+     * Single-biquad flushes queued behind it run meanwhile and are copied
+     * into its image; other commands wait, hence MAX_COMMIT_LEAD_MS. A commit
+     * time already past applies immediately. Before start() the apply runs
+     * inline at once.
+     *
+     * @param commit_epoch_ms Unix time in ms
+     * @return sequence number, or 0 if the clock isn't synced, the time is
+     *         too far ahead, or the queue is full
+     */
+    uint32_t apply_wire_at(const uint8_t (&wire)[2][15 * tas5805m_biquad::BIQUAD_WIRE_BYTES],
+                           int64_t commit_epoch_ms) {
+        int64_t now_ms = epoch_ms();
+        if (now_ms < MIN_SYNCED_EPOCH_MS) {
+            ESP_LOGE(TAG, "No SNTP time yet, can't schedule an apply");
+            return 0;
+        }
+        int64_t lead_ms = commit_epoch_ms - now_ms;
+        if (lead_ms > MAX_COMMIT_LEAD_MS) {
+            ESP_LOGE(TAG, "Commit time %lld ms ahead (max %lld)", (long long)lead_ms,
+                     (long long)MAX_COMMIT_LEAD_MS);
+            return 0;
+        }
+        if (lead_ms < 0) {
+            ESP_LOGW(TAG, "Commit time passed %lld ms ago, applying now", (long long)-lead_ms);
+            lead_ms = 0;
+        }
+
+        return stage_apply(wire, tas5805m_perf::now_us() + static_cast<uint64_t>(lead_ms) * 1000);
+    }
+
+    /**
+     * Queue a reset of all 30 biquads to bypass
+     */
+    uint32_t reset_all() {
+        supersede_slots();
+
+        Command cmd{};
+        cmd.type = CommandType::RESET_ALL;
+        return submit(cmd);
+    }
+
+    /**
+     * Queue a readback of all 30 biquads against the coefficient shadow
+     *
+     * Runs in queue order so the reads see every write queued before it;
+     * the outcome lands in stats().verify_mismatches / verify_repairs.
+     *
+     * @param repair Rewrite biquads that differ (false = only report)
+     */
+    uint32_t verify(bool repair = true) {
+        Command cmd{};
+        cmd.type = CommandType::VERIFY;
+        cmd.repair = repair;
+        return submit(cmd);
+    }
+
+    /**
+     * Commands waiting in the queue
+     */
+    uint32_t pending() const { return static_cast<uint32_t>(count_); }
+
+    const WriterStats& stats() const { return stats_; }
+
+private:
+    esphome::i2c::I2CBus* bus_{nullptr};
+    uint8_t address_{tas5805m_biquad::TAS5805M_ADDR};
+    bool running_{false};
+    uint32_t next_seq_{1};
+    uint32_t coalesce_window_ms_{COALESCE_WINDOW_MS};
+    bool atomic_apply_{true};
+    WriterStats stats_;
+
+    // Pending commands, oldest at head_
+    Command queue_[QUEUE_DEPTH];
+    size_t head_{0};
+    size_t count_{0};
+
+    // Staged profiles for queued APPLY_PROFILE commands, packed, oldest at
+    // staged_head_ (applies run in queue order)
+    uint8_t staged_wire_[STAGED_DEPTH][2][15 * tas5805m_biquad::BIQUAD_WIRE_BYTES];
+    size_t staged_head_{0};
+    size_t staged_count_{0};
+
+    // Pending single-biquad updates, packed, last writer wins
+    uint8_t slots_[2][15 * tas5805m_biquad::BIQUAD_WIRE_BYTES];
+    uint16_t dirty_[2]{0, 0};
+    uint32_t flush_seq_{0};      // Queued flush that will pick up new updates (0 = none)
+    uint32_t generation_{0};     // Bumped whenever a full apply supersedes the slots
+
+    // Pinned slots, written over every full apply
+    uint8_t pinned_wire_[2][15 * tas5805m_biquad::BIQUAD_WIRE_BYTES];
+    uint16_t pinned_[2]{0, 0};
+
+    uint32_t take_seq() {
+        uint32_t seq = next_seq_++;
+        if (next_seq_ == 0) next_seq_ = 1;  // 0 means "rejected"
+        return seq;
+    }
+
+    /**
+     * Drop pending slot updates that a full apply/reset is about to overwrite.
+     * Any flush still in the queue goes stale.
+     */
+    void supersede_slots() {
+        for (int ch = 0; ch < 2; ch++) {
+            for (int i = 0; i < 15; i++) {
+                if (dirty_[ch] & (1u << i)) stats_.coalesced++;
+            }
+            dirty_[ch] = 0;
+        }
+        flush_seq_ = 0;
+        generation_++;
+    }
+
+    uint32_t submit(Command& cmd) {
+        cmd.seq = take_seq();
+        cmd.queued_ms = esphome::millis();
+
+        // Not started yet (boot, host tests): run inline
+        if (!is_running()) {
+            stats_.queued++;
+            bool ok = execute(cmd);
+            finish(cmd, ok, 0);
+            return ok ? cmd.seq : 0;
+        }
+
+        if (count_ == QUEUE_DEPTH) {
+            stats_.rejected++;
+            ESP_LOGW(TAG, "Writer queue full, dropping command %u", (unsigned)cmd.seq);
+            return 0;
+        }
+
+        queue_[(head_ + count_) % QUEUE_DEPTH] = cmd;
+        count_++;
+        stats_.queued++;
+        return cmd.seq;
+    }
+
+    /**
+     * Copy a profile into the next free staged image and queue its apply
+     */
+    uint32_t stage_apply(const uint8_t (&wire)[2][15 * tas5805m_biquad::BIQUAD_WIRE_BYTES],
+                         uint64_t due_us) {
+        if (staged_count_ == STAGED_DEPTH) {
+            stats_.rejected++;
+            ESP_LOGW(TAG, "%d profile applies already staged, dropping this one", (int)STAGED_DEPTH);
+            return 0;
+        }
+
+        size_t image = (staged_head_ + staged_count_) % STAGED_DEPTH;
+        memcpy(staged_wire_[image], wire, sizeof(staged_wire_[0]));
+        staged_count_++;
+        supersede_slots();
+
+        Command cmd{};
+        cmd.type = CommandType::APPLY_PROFILE;
+        cmd.due_us = due_us;
+        cmd.image = static_cast<uint8_t>(image);
+        uint32_t seq = submit(cmd);
+        if (seq == 0 && is_running()) staged_count_--;  // Queue full, never ran
+        return seq;
+    }
+
+    /**
+     * Queue offset of the flush directly behind the head, if it is live
+     * (0 = none)
+     */
+    size_t flush_behind_head() const {
+        if (count_ < 2) return 0;
+        const Command& cmd = queue_[(head_ + 1) % QUEUE_DEPTH];
+        if (cmd.type != CommandType::FLUSH_SLOTS || cmd.generation != generation_) return 0;
+        return 1;
+    }
+
+    /**
+     * Remove the command at a queue offset, closing the gap
+     */
+    Command take(size_t pos) {
+        Command cmd = queue_[(head_ + pos) % QUEUE_DEPTH];
+        for (size_t i = pos; i > 0; i--) {
+            queue_[(head_ + i) % QUEUE_DEPTH] = queue_[(head_ + i - 1) % QUEUE_DEPTH];
+        }
+        head_ = (head_ + 1) % QUEUE_DEPTH;
+        count_--;
+        return cmd;
+    }
+
+    /**
+     * Bytes a write of `wire` to one slot puts on the chip: the pinned
+     * coefficients if the slot is pinned
+     */
+    const uint8_t* slot_wire(int ch, int index, const uint8_t* wire) const {
+        if (!(pinned_[ch] & (1u << index))) return wire;
+        return &pinned_wire_[ch][index * tas5805m_biquad::BIQUAD_WIRE_BYTES];
+    }
+
+    /**
+     * Copy the pinned slots over a full 30-biquad image
+     */
+    void overlay_pinned(uint8_t (&wire)[2][15 * tas5805m_biquad::BIQUAD_WIRE_BYTES]) const {
+        for (int ch = 0; ch < 2; ch++) {
+            for (int i = 0; i < 15; i++) {
+                if (!(pinned_[ch] & (1u << i))) continue;
+                memcpy(&wire[ch][i * tas5805m_biquad::BIQUAD_WIRE_BYTES],
+                       &pinned_wire_[ch][i * tas5805m_biquad::BIQUAD_WIRE_BYTES],
+                       tas5805m_biquad::BIQUAD_WIRE_BYTES);
+            }
+        }
+    }
+
+    /**
+     * Busy-wait the last stretch before a scheduled apply
+     *
+     * loop() only gets here within COMMIT_SPIN_US of the commit time, so
+     * the main loop is held for at most one pass, once per scheduled apply.
+     */
+    void wait_until(uint64_t due_us) {
+        while (tas5805m_perf::now_us() < due_us) {
+        }
+
+        int64_t skew = static_cast<int64_t>(tas5805m_perf::now_us() - due_us);
+        stats_.last_commit_skew_us = static_cast<int32_t>(skew > INT32_MAX ? INT32_MAX : skew);
+        stats_.scheduled++;
+    }
+
+    bool execute(const Command& cmd) {
+        switch (cmd.type) {
+            case CommandType::FLUSH_SLOTS:
+                return flush_slots(cmd);
+
+            case CommandType::APPLY_PROFILE: {
+                uint8_t wire[2][15 * tas5805m_biquad::BIQUAD_WIRE_BYTES];
+                memcpy(wire, staged_wire_[cmd.image], sizeof(wire));
+                staged_head_ = (staged_head_ + 1) % STAGED_DEPTH;
+                staged_count_--;
+                overlay_pinned(wire);
+                if (atomic_apply_) {
+                    return tas5805m_biquad::write_all_biquads_atomic_wire(bus_, address_, wire);
+                }
+                return tas5805m_biquad::write_all_biquads_wire(bus_, address_, wire);
+            }
+
+            case CommandType::RESET_ALL: {
+                tas5805m_biquad::BiquadCoeffs bypass[15];
+                uint8_t wire[2][15 * tas5805m_biquad::BIQUAD_WIRE_BYTES];
+                tas5805m_biquad::pack_channels(bypass, bypass, wire);
+                overlay_pinned(wire);
+                return tas5805m_biquad::write_all_biquads_wire(bus_, address_, wire);
+            }
+
+            case CommandType::VERIFY: {
+                tas5805m_biquad::VerifyResult result;
+                bool ok = tas5805m_biquad::verify_coeff_shadow(bus_, address_, cmd.repair, &result);
+                stats_.verify_mismatches = result.mismatched;
+                stats_.verify_repairs = result.repaired;
+                return ok;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Write the dirty slots as delta runs
+     */
+    bool flush_slots(const Command& cmd) {
+        // A full apply was queued after this flush and replaces its slots
+        if (cmd.generation != generation_) return true;
+
+        uint16_t mask[2] = {dirty_[0], dirty_[1]};
+        dirty_[0] = dirty_[1] = 0;
+        flush_seq_ = 0;
+
+        // Applies still staged were queued before this flush (a later one
+        // would have made it stale): its slots win there too
+        for (size_t n = 0; n < staged_count_; n++) {
+            auto& image = staged_wire_[(staged_head_ + n) % STAGED_DEPTH];
+            for (int ch = 0; ch < 2; ch++) {
+                for (int i = 0; i < 15; i++) {
+                    if (!(mask[ch] & (1u << i))) continue;
+                    memcpy(&image[ch][i * tas5805m_biquad::BIQUAD_WIRE_BYTES],
+                           &slots_[ch][i * tas5805m_biquad::BIQUAD_WIRE_BYTES],
+                           tas5805m_biquad::BIQUAD_WIRE_BYTES);
+                }
+            }
+        }
+
+        tas5805m_biquad::TAS5805M_I2C dev(bus_, address_);
+        tas5805m_biquad::CoeffSession session(bus_, address_);
+        bool success = true;
+        for (int ch = 0; ch < 2; ch++) {
+            if (mask[ch] == 0) continue;
+            if (!tas5805m_biquad::write_channel_delta(dev, ch, slots_[ch], nullptr, mask[ch])) {
+                success = false;
+            }
+        }
+        return success;
+    }
+
+    void finish(const Command& cmd, bool ok, uint32_t duration_ms) {
+        if (ok) {
+            stats_.completed++;
+        } else {
+            stats_.failed++;
+            ESP_LOGE(TAG, "Command %u failed", (unsigned)cmd.seq);
+        }
+        stats_.last_ok = ok;
+        stats_.last_duration_ms = duration_ms;
+        stats_.last_seq = cmd.seq;
+    }
+};
+
+// =============================================================================
+// GLOBAL INSTANCE
+// =============================================================================
+
+static CoeffWriter g_coeff_writer;
+
+inline CoeffWriter& coeff_writer() { return g_coeff_writer; }
+
+}  // namespace tas5805m_writer
@@ -0,0 +1,111 @@
+/**
+ * CRC32 for TAS5805M profile storage
+ *
+ * Standard reflected CRC-32 (IEEE 802.3, poly 0xEDB88320, init/xorout
+ * 0xFFFFFFFF), bit-compatible with the checksums already stored in NVS.
+ *
+ * - On ESP32 the ROM implementation (esp_rom_crc32_le) is used.
+ * - Elsewhere (host tests) a slicing-by-8 table processes 8 bytes per step.
+ *
+ * No ESPHome dependencies, so the host tests include it directly.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(ESP_PLATFORM)
+#include "esp_rom_crc.h"
+#endif
+
+namespace tas5805m_crc {
+
+constexpr uint32_t CRC32_POLY = 0xEDB88320;  // Reflected IEEE polynomial
+
+/**
+ * Reference implementation, one bit at a time
+ */
+inline uint32_t crc32_bitwise(const uint8_t* data, size_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ (CRC32_POLY & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+// =============================================================================
+// SLICING-BY-8
+// =============================================================================
+
+struct Crc32Tables {
+    uint32_t t[8][256];
+};
+
+/**
+ * Build the 8 lookup tables at compile time: t[0] is the classic byte table,
+ * t[k][i] is the CRC of byte i followed by k zero bytes.
+ */
+constexpr Crc32Tables make_crc32_tables() {
+    Crc32Tables tables{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ (CRC32_POLY & (0u - (crc & 1)));
+        }
+        tables.t[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int k = 1; k < 8; k++) {
+            uint32_t prev = tables.t[k - 1][i];
+            tables.t[k][i] = (prev >> 8) ^ tables.t[0][prev & 0xFF];
+        }
+    }
+    return tables;
+}
+
+/**
+ * Table-driven implementation, 8 bytes per iteration
+ */
+inline uint32_t crc32_slice8(const uint8_t* data, size_t len) {
+    static constexpr Crc32Tables tables = make_crc32_tables();
+    const auto& t = tables.t;
+
+    uint32_t crc = 0xFFFFFFFF;
+
+    // Bytes are assembled explicitly, so alignment and endianness don't matter
+    while (len >= 8) {
+        uint32_t lo = crc ^ (static_cast<uint32_t>(data[0]) |
+                             static_cast<uint32_t>(data[1]) << 8 |
+                             static_cast<uint32_t>(data[2]) << 16 |
+                             static_cast<uint32_t>(data[3]) << 24);
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^
+              t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+        data += 8;
+        len -= 8;
+    }
+
+    while (len--) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+    }
+
+    return ~crc;
+}
+
+/**
+ * CRC32 of a buffer using the fastest engine available
+ */
+inline uint32_t crc32(const uint8_t* data, size_t len) {
+#if defined(ESP_PLATFORM)
+    // ROM crc32_le takes and returns the finalized value; 0 starts a new CRC
+    return esp_rom_crc32_le(0, data, len);
+#else
+    return crc32_slice8(data, len);
+#endif
+}
+
+}  // namespace tas5805m_crc
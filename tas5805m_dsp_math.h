@@ -0,0 +1,752 @@
+/**
+ * TAS5805M DSP Math Core
+ *
+ * Pure coefficient math shared by the firmware and the host tests:
+ * parameter validation, RBJ filter design (runtime and constexpr), filter
+ * designs that can be recomputed at any sample rate, 9.23 fixed-point
+ * conversion and packing into the 20-byte DSP layout.
+ *
+ * No ESPHome or bus dependencies and no side effects. If the ESPHome
+ * logging macros are not defined before inclusion, they compile to nothing.
+ *
+ * Usage:
+ *   #include "tas5805m_dsp_math.h"
+ *   tas5805m_biquad::FilterCoeffs c = tas5805m_biquad::calc_parametric_eq(1000.0f, -3.0f, 2.0f);
+ *   uint8_t wire[tas5805m_biquad::BIQUAD_WIRE_BYTES];
+ *   tas5805m_biquad::pack_biquad(c, wire);
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <type_traits>
+
+#ifndef ESP_LOGE
+#define ESP_LOGE(tag, ...) ((void)0)
+#endif
+#ifndef ESP_LOGW
+#define ESP_LOGW(tag, ...) ((void)0)
+#endif
+#ifndef ESP_LOGI
+#define ESP_LOGI(tag, ...) ((void)0)
+#endif
+#ifndef ESP_LOGD
+#define ESP_LOGD(tag, ...) ((void)0)
+#endif
+#ifndef ESP_LOGV
+#define ESP_LOGV(tag, ...) ((void)0)
+#endif
+
+// =============================================================================
+// LOG LEVEL GATING
+// =============================================================================
+//
+// Per-component verbosity, fixed at compile time and independent of the
+// ESPHome logger level. Statements above the level are dead code and are
+// removed, arguments and float formatting included. Set from the YAML with
+//   esphome:
+//     platformio_options:
+//       build_flags: -DTAS5805M_BQ_LOG_LEVEL=5
+//
+// At the default (INFO) the coefficient paths log one summary line per
+// operation; DEBUG adds per-biquad lines, VERBOSE the coefficient values.
+
+#define TAS5805M_LOG_LEVEL_NONE 0
+#define TAS5805M_LOG_LEVEL_ERROR 1
+#define TAS5805M_LOG_LEVEL_WARN 2
+#define TAS5805M_LOG_LEVEL_INFO 3
+#define TAS5805M_LOG_LEVEL_DEBUG 5      // Same numbering as ESPHOME_LOG_LEVEL_*
+#define TAS5805M_LOG_LEVEL_VERBOSE 6
+
+#ifndef TAS5805M_BQ_LOG_LEVEL
+#define TAS5805M_BQ_LOG_LEVEL TAS5805M_LOG_LEVEL_INFO         // Tag "tas5805m_bq"
+#endif
+#ifndef TAS5805M_PROFILE_LOG_LEVEL
+#define TAS5805M_PROFILE_LOG_LEVEL TAS5805M_LOG_LEVEL_INFO    // Tag "tas5805m_profile"
+#endif
+
+#define TAS5805M_LOG_GATED(limit, level, log_macro, tag, ...) \
+    do { \
+        if ((level) <= (limit)) { log_macro(tag, __VA_ARGS__); } \
+    } while (0)
+
+#define TAS5805M_BQ_LOGE(...) TAS5805M_LOG_GATED(TAS5805M_BQ_LOG_LEVEL, TAS5805M_LOG_LEVEL_ERROR, ESP_LOGE, "tas5805m_bq", __VA_ARGS__)
+#define TAS5805M_BQ_LOGW(...) TAS5805M_LOG_GATED(TAS5805M_BQ_LOG_LEVEL, TAS5805M_LOG_LEVEL_WARN, ESP_LOGW, "tas5805m_bq", __VA_ARGS__)
+#define TAS5805M_BQ_LOGI(...) TAS5805M_LOG_GATED(TAS5805M_BQ_LOG_LEVEL, TAS5805M_LOG_LEVEL_INFO, ESP_LOGI, "tas5805m_bq", __VA_ARGS__)
+#define TAS5805M_BQ_LOGD(...) TAS5805M_LOG_GATED(TAS5805M_BQ_LOG_LEVEL, TAS5805M_LOG_LEVEL_DEBUG, ESP_LOGD, "tas5805m_bq", __VA_ARGS__)
+#define TAS5805M_BQ_LOGV(...) TAS5805M_LOG_GATED(TAS5805M_BQ_LOG_LEVEL, TAS5805M_LOG_LEVEL_VERBOSE, ESP_LOGV, "tas5805m_bq", __VA_ARGS__)
+
+#define TAS5805M_PROFILE_LOGE(...) TAS5805M_LOG_GATED(TAS5805M_PROFILE_LOG_LEVEL, TAS5805M_LOG_LEVEL_ERROR, ESP_LOGE, "tas5805m_profile", __VA_ARGS__)
+#define TAS5805M_PROFILE_LOGW(...) TAS5805M_LOG_GATED(TAS5805M_PROFILE_LOG_LEVEL, TAS5805M_LOG_LEVEL_WARN, ESP_LOGW, "tas5805m_profile", __VA_ARGS__)
+#define TAS5805M_PROFILE_LOGI(...) TAS5805M_LOG_GATED(TAS5805M_PROFILE_LOG_LEVEL, TAS5805M_LOG_LEVEL_INFO, ESP_LOGI, "tas5805m_profile", __VA_ARGS__)
+#define TAS5805M_PROFILE_LOGD(...) TAS5805M_LOG_GATED(TAS5805M_PROFILE_LOG_LEVEL, TAS5805M_LOG_LEVEL_DEBUG, ESP_LOGD, "tas5805m_profile", __VA_ARGS__)
+
+namespace tas5805m_biquad {
+
+// =============================================================================
+// WIRE FORMAT
+// =============================================================================
+
+constexpr size_t BIQUADS_PER_CHANNEL = 15;
+constexpr size_t BIQUAD_WIRE_BYTES = 20;  // 5 coefficients x 4 bytes
+
+// =============================================================================
+// VALIDATION HELPERS
+// =============================================================================
+
+/**
+ * Validate channel parameter
+ * @param channel 0=left, 1=right, 2=both
+ * @return true if valid
+ */
+inline bool validate_channel(int channel) {
+    if (channel < 0 || channel > 2) {
+        TAS5805M_BQ_LOGE("Invalid channel: %d (must be 0-2)", channel);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Validate biquad index parameter
+ * @param index 0-14
+ * @return true if valid
+ */
+inline bool validate_index(int index) {
+    if (index < 0 || index >= 15) {
+        TAS5805M_BQ_LOGE("Invalid biquad index: %d (must be 0-14)", index);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Validate frequency parameter
+ * @param frequency in Hz
+ * @param min_freq minimum allowed frequency (default 10 Hz)
+ * @param max_freq maximum allowed frequency (default 24000 Hz)
+ * @return true if valid
+ */
+inline bool validate_frequency(float frequency, float min_freq = 10.0f, float max_freq = 24000.0f) {
+    if (!std::isfinite(frequency) || frequency < min_freq || frequency > max_freq) {
+        TAS5805M_BQ_LOGE("Invalid frequency: %.1f (must be %.0f-%.0f Hz)", frequency, min_freq, max_freq);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Validate gain parameter
+ * @param gain_db in dB
+ * @param min_gain minimum allowed gain (default -20 dB)
+ * @param max_gain maximum allowed gain (default +20 dB)
+ * @return true if valid
+ */
+inline bool validate_gain(float gain_db, float min_gain = -20.0f, float max_gain = 20.0f) {
+    if (!std::isfinite(gain_db) || gain_db < min_gain || gain_db > max_gain) {
+        TAS5805M_BQ_LOGE("Invalid gain: %.1f (must be %.0f to +%.0f dB)", gain_db, min_gain, max_gain);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Validate Q factor parameter
+ * @param q Q factor
+ * @param min_q minimum allowed Q (default 0.1)
+ * @param max_q maximum allowed Q (default 20)
+ * @return true if valid
+ */
+inline bool validate_q(float q, float min_q = 0.1f, float max_q = 20.0f) {
+    if (!std::isfinite(q) || q < min_q || q > max_q) {
+        TAS5805M_BQ_LOGE("Invalid Q: %.2f (must be %.1f-%.0f)", q, min_q, max_q);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Validate slope parameter (for shelf filters)
+ * @param slope shelf slope
+ * @param min_slope minimum allowed slope (default 0.1)
+ * @param max_slope maximum allowed slope (default 5.0)
+ * @return true if valid
+ */
+inline bool validate_slope(float slope, float min_slope = 0.1f, float max_slope = 5.0f) {
+    if (!std::isfinite(slope) || slope < min_slope || slope > max_slope) {
+        TAS5805M_BQ_LOGE("Invalid slope: %.2f (must be %.1f-%.1f)", slope, min_slope, max_slope);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Validate biquad coefficients
+ * @return true if all coefficients are finite
+ */
+inline bool validate_coefficients(float b0, float b1, float b2, float a1, float a2) {
+    if (!std::isfinite(b0) || !std::isfinite(b1) || !std::isfinite(b2) ||
+        !std::isfinite(a1) || !std::isfinite(a2)) {
+        TAS5805M_BQ_LOGE("Coefficient contains NaN or Inf");
+        return false;
+    }
+    return true;
+}
+
+// =============================================================================
+// COEFFICIENT CONVERSION
+// =============================================================================
+
+/**
+ * Convert float to TAS5805M 9.23 fixed-point format
+ */
+inline int32_t float_to_9_23(float value) {
+    // Check for invalid values (NaN, Infinity)
+    if (!std::isfinite(value)) {
+        TAS5805M_BQ_LOGE("Invalid coefficient: %f (NaN or Inf), using bypass", value);
+        return 0;  // Return bypass coefficient
+    }
+
+    // Clamp to valid range for 9.23 format
+    if (value > 255.999999f) value = 255.999999f;
+    if (value < -256.0f) value = -256.0f;
+
+    return static_cast<int32_t>(value * (1 << 23));
+}
+
+/**
+ * Pack 32-bit value into big-endian byte buffer
+ */
+inline void pack_be32(int32_t value, uint8_t* buffer) {
+    buffer[0] = (value >> 24) & 0xFF;
+    buffer[1] = (value >> 16) & 0xFF;
+    buffer[2] = (value >> 8) & 0xFF;
+    buffer[3] = value & 0xFF;
+}
+
+/**
+ * Pack normalized coefficients into the 20-byte form stored in DSP memory
+ * (9.23 big-endian, a1/a2 sign-inverted)
+ */
+inline void pack_coeffs(float b0, float b1, float b2, float a1, float a2, uint8_t* out) {
+    pack_be32(float_to_9_23(b0), &out[0]);
+    pack_be32(float_to_9_23(b1), &out[4]);
+    pack_be32(float_to_9_23(b2), &out[8]);
+    pack_be32(float_to_9_23(-a1), &out[12]);  // Sign inverted!
+    pack_be32(float_to_9_23(-a2), &out[16]);  // Sign inverted!
+}
+
+/**
+ * Normalized biquad coefficient set (a0 = 1)
+ */
+struct BiquadCoeffs {
+    float b0, b1, b2, a1, a2;
+
+    BiquadCoeffs() : b0(1.0f), b1(0.0f), b2(0.0f), a1(0.0f), a2(0.0f) {}
+    BiquadCoeffs(float _b0, float _b1, float _b2, float _a1, float _a2)
+        : b0(_b0), b1(_b1), b2(_b2), a1(_a1), a2(_a2) {}
+
+    // Check if this is a bypass filter (passthrough)
+    bool is_bypass() const {
+        return (std::fabs(b0 - 1.0f) < 0.0001f &&
+                std::fabs(b1) < 0.0001f &&
+                std::fabs(b2) < 0.0001f &&
+                std::fabs(a1) < 0.0001f &&
+                std::fabs(a2) < 0.0001f);
+    }
+};
+
+static_assert(std::is_trivially_copyable<BiquadCoeffs>::value &&
+              std::is_trivially_destructible<BiquadCoeffs>::value,
+              "BiquadCoeffs is passed in fixed arrays and must not own heap memory");
+
+// Name used by the calc_* API and the host tests
+using FilterCoeffs = BiquadCoeffs;
+
+/**
+ * Pack a coefficient set into its 20-byte wire form
+ */
+inline void pack_biquad(const BiquadCoeffs& c, uint8_t* out) {
+    pack_coeffs(c.b0, c.b1, c.b2, c.a1, c.a2, out);
+}
+
+/**
+ * Convert TAS5805M 9.23 fixed-point back to float
+ */
+inline float fixed_9_23_to_float(int32_t value) {
+    return static_cast<float>(value) / (1 << 23);
+}
+
+/**
+ * Read a 32-bit value from a big-endian byte buffer
+ */
+inline int32_t unpack_be32(const uint8_t* buffer) {
+    return static_cast<int32_t>((static_cast<uint32_t>(buffer[0]) << 24) |
+                                (static_cast<uint32_t>(buffer[1]) << 16) |
+                                (static_cast<uint32_t>(buffer[2]) << 8) |
+                                static_cast<uint32_t>(buffer[3]));
+}
+
+/**
+ * Decode a 20-byte wire form (as read back from DSP memory) into a
+ * coefficient set; inverse of pack_biquad up to 9.23 rounding
+ */
+inline BiquadCoeffs unpack_biquad(const uint8_t* wire) {
+    return BiquadCoeffs(fixed_9_23_to_float(unpack_be32(&wire[0])),
+                        fixed_9_23_to_float(unpack_be32(&wire[4])),
+                        fixed_9_23_to_float(unpack_be32(&wire[8])),
+                        -fixed_9_23_to_float(unpack_be32(&wire[12])),   // Stored inverted
+                        -fixed_9_23_to_float(unpack_be32(&wire[16])));  // Stored inverted
+}
+
+// =============================================================================
+// COMPILE-TIME FILTER DESIGN
+// =============================================================================
+
+// constexpr versions of the RBJ designers below, evaluated in double at
+// build time. For a fixed filter the packed 9.23 words end up in flash and
+// no trig runs on the device; write them with write_biquad_wire().
+
+namespace cx {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double LN10 = 2.30258509299404568402;
+
+constexpr double abs(double x) { return x < 0.0 ? -x : x; }
+
+constexpr double sqrt(double x) {
+    if (x <= 0.0) return 0.0;
+    double r = x > 1.0 ? x : 1.0;
+    for (int i = 0; i < 64; i++) {
+        double next = 0.5 * (r + x / r);
+        if (next == r) break;
+        r = next;
+    }
+    return r;
+}
+
+constexpr double sin(double x) {
+    // Reduce to [-pi, pi], then Taylor series (converges to double precision)
+    long long turns = static_cast<long long>(x / (2.0 * PI) + (x < 0.0 ? -0.5 : 0.5));
+    x -= static_cast<double>(turns) * 2.0 * PI;
+    double term = x, sum = x;
+    for (int n = 1; n < 20; n++) {
+        term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double cos(double x) { return sin(x + PI / 2.0); }
+
+constexpr double exp(double x) {
+    // exp(x) = exp(x / 2^k)^(2^k) with |x / 2^k| < 0.5
+    int k = 0;
+    while (abs(x) > 0.5) { x *= 0.5; k++; }
+    double term = 1.0, sum = 1.0;
+    for (int n = 1; n < 20; n++) {
+        term *= x / n;
+        sum += term;
+    }
+    while (k-- > 0) sum *= sum;
+    return sum;
+}
+
+constexpr double pow10(double x) { return exp(x * LN10); }
+
+}  // namespace cx
+
+/**
+ * One packed biquad (20 bytes, same layout as pack_coeffs)
+ */
+struct BiquadWire {
+    uint8_t bytes[BIQUAD_WIRE_BYTES];
+};
+
+/**
+ * constexpr float_to_9_23 + pack_be32 (same clamping and truncation)
+ */
+constexpr void pack_9_23_constexpr(double value, uint8_t* out) {
+    float v = static_cast<float>(value);
+    if (v > 255.999999f) v = 255.999999f;
+    if (v < -256.0f) v = -256.0f;
+    int32_t fixed = static_cast<int32_t>(v * (1 << 23));
+    uint32_t bits = static_cast<uint32_t>(fixed);
+    out[0] = (bits >> 24) & 0xFF;
+    out[1] = (bits >> 16) & 0xFF;
+    out[2] = (bits >> 8) & 0xFF;
+    out[3] = bits & 0xFF;
+}
+
+/**
+ * Normalize by a0 and pack (a1/a2 sign-inverted), all at compile time
+ */
+constexpr BiquadWire make_wire(double b0, double b1, double b2,
+                               double a0, double a1, double a2) {
+    BiquadWire w{};
+    pack_9_23_constexpr(b0 / a0, &w.bytes[0]);
+    pack_9_23_constexpr(b1 / a0, &w.bytes[4]);
+    pack_9_23_constexpr(b2 / a0, &w.bytes[8]);
+    pack_9_23_constexpr(-a1 / a0, &w.bytes[12]);
+    pack_9_23_constexpr(-a2 / a0, &w.bytes[16]);
+    return w;
+}
+
+constexpr BiquadWire design_parametric_eq(double frequency, double gain_db, double q,
+                                          double fs = 48000.0) {
+    const double A = cx::pow10(gain_db / 40.0);
+    const double omega = 2.0 * cx::PI * frequency / fs;
+    const double cos_omega = cx::cos(omega);
+    const double alpha = cx::sin(omega) / (2.0 * q);
+    return make_wire(1.0 + alpha * A, -2.0 * cos_omega, 1.0 - alpha * A,
+                     1.0 + alpha / A, -2.0 * cos_omega, 1.0 - alpha / A);
+}
+
+constexpr BiquadWire design_low_shelf(double frequency, double gain_db, double slope = 1.0,
+                                      double fs = 48000.0) {
+    const double A = cx::pow10(gain_db / 40.0);
+    const double omega = 2.0 * cx::PI * frequency / fs;
+    const double cos_omega = cx::cos(omega);
+    const double alpha = cx::sin(omega) / 2.0 * cx::sqrt((A + 1.0 / A) * (1.0 / slope - 1.0) + 2.0);
+    const double k = 2.0 * cx::sqrt(A) * alpha;
+    return make_wire(A * ((A + 1.0) - (A - 1.0) * cos_omega + k),
+                     2.0 * A * ((A - 1.0) - (A + 1.0) * cos_omega),
+                     A * ((A + 1.0) - (A - 1.0) * cos_omega - k),
+                     (A + 1.0) + (A - 1.0) * cos_omega + k,
+                     -2.0 * ((A - 1.0) + (A + 1.0) * cos_omega),
+                     (A + 1.0) + (A - 1.0) * cos_omega - k);
+}
+
+constexpr BiquadWire design_high_shelf(double frequency, double gain_db, double slope = 1.0,
+                                       double fs = 48000.0) {
+    const double A = cx::pow10(gain_db / 40.0);
+    const double omega = 2.0 * cx::PI * frequency / fs;
+    const double cos_omega = cx::cos(omega);
+    const double alpha = cx::sin(omega) / 2.0 * cx::sqrt((A + 1.0 / A) * (1.0 / slope - 1.0) + 2.0);
+    const double k = 2.0 * cx::sqrt(A) * alpha;
+    return make_wire(A * ((A + 1.0) + (A - 1.0) * cos_omega + k),
+                     -2.0 * A * ((A - 1.0) + (A + 1.0) * cos_omega),
+                     A * ((A + 1.0) + (A - 1.0) * cos_omega - k),
+                     (A + 1.0) - (A - 1.0) * cos_omega + k,
+                     2.0 * ((A - 1.0) - (A + 1.0) * cos_omega),
+                     (A + 1.0) - (A - 1.0) * cos_omega - k);
+}
+
+constexpr BiquadWire design_highpass(double frequency, double q, double fs = 48000.0) {
+    const double omega = 2.0 * cx::PI * frequency / fs;
+    const double cos_omega = cx::cos(omega);
+    const double alpha = cx::sin(omega) / (2.0 * q);
+    return make_wire((1.0 + cos_omega) / 2.0, -(1.0 + cos_omega), (1.0 + cos_omega) / 2.0,
+                     1.0 + alpha, -2.0 * cos_omega, 1.0 - alpha);
+}
+
+constexpr BiquadWire design_lowpass(double frequency, double q, double fs = 48000.0) {
+    const double omega = 2.0 * cx::PI * frequency / fs;
+    const double cos_omega = cx::cos(omega);
+    const double alpha = cx::sin(omega) / (2.0 * q);
+    return make_wire((1.0 - cos_omega) / 2.0, 1.0 - cos_omega, (1.0 - cos_omega) / 2.0,
+                     1.0 + alpha, -2.0 * cos_omega, 1.0 - alpha);
+}
+
+constexpr BiquadWire design_notch(double frequency, double q, double fs = 48000.0) {
+    const double omega = 2.0 * cx::PI * frequency / fs;
+    const double cos_omega = cx::cos(omega);
+    const double alpha = cx::sin(omega) / (2.0 * q);
+    return make_wire(1.0, -2.0 * cos_omega, 1.0,
+                     1.0 + alpha, -2.0 * cos_omega, 1.0 - alpha);
+}
+
+// Centre frequencies of the tas5805m driver's 15-band graphic EQ
+constexpr float GRAPHIC_EQ_CENTRES_HZ[15] = {
+    20.0f, 31.5f, 50.0f, 80.0f, 125.0f, 200.0f, 315.0f, 500.0f,
+    800.0f, 1250.0f, 2000.0f, 3150.0f, 5000.0f, 8000.0f, 16000.0f
+};
+
+/**
+ * sin/cos of omega = 2*pi*f/fs for one frequency
+ */
+struct TrigPair {
+    float frequency, fs, sin_omega, cos_omega;
+};
+
+// Bypass, also a build-time check of the constexpr packer
+constexpr BiquadWire PRESET_BYPASS = make_wire(1.0, 0.0, 0.0, 1.0, 0.0, 0.0);
+
+static_assert(PRESET_BYPASS.bytes[0] == 0x00 && PRESET_BYPASS.bytes[1] == 0x80 &&
+              PRESET_BYPASS.bytes[4] == 0x00 && PRESET_BYPASS.bytes[19] == 0x00,
+              "constexpr packer must match pack_coeffs (b0 = 1.0 -> 0x00800000)");
+
+// =============================================================================
+// RUNTIME TRIG CACHE
+// =============================================================================
+
+/**
+ * Small direct-mapped cache of (fs, frequency) -> sin/cos(omega)
+ *
+ * Slider-driven services recompute the same handful of centre frequencies
+ * over and over; only the gain/Q terms actually change. Seeded with the
+ * graphic EQ centres at 48 kHz. Seeds and misses go through the same
+ * compute(), so a design never depends on what the cache held before.
+ * Used from the main loop only.
+ */
+class TrigCache {
+public:
+    static constexpr size_t SIZE = 32;
+
+    TrigCache() {
+        for (float frequency : GRAPHIC_EQ_CENTRES_HZ) {
+            entries_[slot(frequency, 48000.0f)] = compute(frequency, 48000.0f);
+        }
+    }
+
+    void lookup(float frequency, float fs, float& sin_omega, float& cos_omega) {
+        TrigPair& entry = entries_[slot(frequency, fs)];
+        if (entry.frequency != frequency || entry.fs != fs) {
+            entry = compute(frequency, fs);
+        }
+        sin_omega = entry.sin_omega;
+        cos_omega = entry.cos_omega;
+    }
+
+private:
+    TrigPair entries_[SIZE]{};  // frequency 0 never matches a validated request
+
+    static size_t slot(float frequency, float fs) {
+        uint32_t f_bits, fs_bits;
+        memcpy(&f_bits, &frequency, sizeof(f_bits));
+        memcpy(&fs_bits, &fs, sizeof(fs_bits));
+        return ((f_bits ^ (fs_bits >> 7)) * 2654435761u) >> 27;  // top 5 bits
+    }
+
+    static TrigPair compute(float frequency, float fs) {
+        const float omega = 2.0f * M_PI * frequency / fs;
+        return TrigPair{frequency, fs, std::sin(omega), std::cos(omega)};
+    }
+};
+
+static_assert(TrigCache::SIZE == 32, "slot() returns the top 5 hash bits");
+
+static TrigCache g_trig_cache;
+
+/**
+ * sin/cos of 2*pi*frequency/fs, through the cache
+ */
+inline void omega_sin_cos(float frequency, float fs, float& sin_omega, float& cos_omega) {
+    g_trig_cache.lookup(frequency, fs, sin_omega, cos_omega);
+}
+
+// =============================================================================
+// FILTER COEFFICIENT CALCULATORS
+// =============================================================================
+
+// The calc_* functions only compute coefficients (normalized by a0, RBJ
+// cookbook); the write_* wrappers below also program them into the DSP.
+
+/**
+ * Parametric EQ from precomputed sin/cos(omega)
+ *
+ * For callers sweeping many frequencies (the cascade optimizer), which
+ * would only churn the trig cache.
+ */
+inline BiquadCoeffs calc_parametric_eq_omega(float sin_omega, float cos_omega,
+                                             float gain_db, float q) {
+    const float A = std::pow(10.0f, gain_db / 40.0f);
+    const float alpha = sin_omega / (2.0f * q);
+
+    float b0 = 1.0f + alpha * A;
+    float b1 = -2.0f * cos_omega;
+    float b2 = 1.0f - alpha * A;
+    float a0 = 1.0f + alpha / A;
+    float a1 = -2.0f * cos_omega;
+    float a2 = 1.0f - alpha / A;
+
+    return BiquadCoeffs(b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0);
+}
+
+/**
+ * Calculate a parametric EQ (peaking) filter
+ */
+inline BiquadCoeffs calc_parametric_eq(float frequency, float gain_db, float q,
+                                       float fs = 48000.0f) {
+    float sin_omega, cos_omega;
+    omega_sin_cos(frequency, fs, sin_omega, cos_omega);
+    return calc_parametric_eq_omega(sin_omega, cos_omega, gain_db, q);
+}
+
+/**
+ * Calculate a low shelf filter
+ */
+inline BiquadCoeffs calc_low_shelf(float frequency, float gain_db, float slope = 1.0f,
+                                   float fs = 48000.0f) {
+    const float A = std::pow(10.0f, gain_db / 40.0f);
+    float sin_omega, cos_omega;
+    omega_sin_cos(frequency, fs, sin_omega, cos_omega);
+    const float alpha = sin_omega / 2.0f * std::sqrt((A + 1.0f/A) * (1.0f/slope - 1.0f) + 2.0f);
+    const float two_sqrt_A_alpha = 2.0f * std::sqrt(A) * alpha;
+
+    float b0 = A * ((A + 1.0f) - (A - 1.0f) * cos_omega + two_sqrt_A_alpha);
+    float b1 = 2.0f * A * ((A - 1.0f) - (A + 1.0f) * cos_omega);
+    float b2 = A * ((A + 1.0f) - (A - 1.0f) * cos_omega - two_sqrt_A_alpha);
+    float a0 = (A + 1.0f) + (A - 1.0f) * cos_omega + two_sqrt_A_alpha;
+    float a1 = -2.0f * ((A - 1.0f) + (A + 1.0f) * cos_omega);
+    float a2 = (A + 1.0f) + (A - 1.0f) * cos_omega - two_sqrt_A_alpha;
+
+    return BiquadCoeffs(b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0);
+}
+
+/**
+ * Calculate a high shelf filter
+ */
+inline BiquadCoeffs calc_high_shelf(float frequency, float gain_db, float slope = 1.0f,
+                                    float fs = 48000.0f) {
+    const float A = std::pow(10.0f, gain_db / 40.0f);
+    float sin_omega, cos_omega;
+    omega_sin_cos(frequency, fs, sin_omega, cos_omega);
+    const float alpha = sin_omega / 2.0f * std::sqrt((A + 1.0f/A) * (1.0f/slope - 1.0f) + 2.0f);
+    const float two_sqrt_A_alpha = 2.0f * std::sqrt(A) * alpha;
+
+    float b0 = A * ((A + 1.0f) + (A - 1.0f) * cos_omega + two_sqrt_A_alpha);
+    float b1 = -2.0f * A * ((A - 1.0f) + (A + 1.0f) * cos_omega);
+    float b2 = A * ((A + 1.0f) + (A - 1.0f) * cos_omega - two_sqrt_A_alpha);
+    float a0 = (A + 1.0f) - (A - 1.0f) * cos_omega + two_sqrt_A_alpha;
+    float a1 = 2.0f * ((A - 1.0f) - (A + 1.0f) * cos_omega);
+    float a2 = (A + 1.0f) - (A - 1.0f) * cos_omega - two_sqrt_A_alpha;
+
+    return BiquadCoeffs(b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0);
+}
+
+/**
+ * Calculate a high-pass filter
+ */
+inline BiquadCoeffs calc_highpass(float frequency, float q, float fs = 48000.0f) {
+    float sin_omega, cos_omega;
+    omega_sin_cos(frequency, fs, sin_omega, cos_omega);
+    const float alpha = sin_omega / (2.0f * q);
+
+    float b0 = (1.0f + cos_omega) / 2.0f;
+    float b1 = -(1.0f + cos_omega);
+    float b2 = (1.0f + cos_omega) / 2.0f;
+    float a0 = 1.0f + alpha;
+    float a1 = -2.0f * cos_omega;
+    float a2 = 1.0f - alpha;
+
+    return BiquadCoeffs(b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0);
+}
+
+/**
+ * Calculate a low-pass filter
+ */
+inline BiquadCoeffs calc_lowpass(float frequency, float q, float fs = 48000.0f) {
+    float sin_omega, cos_omega;
+    omega_sin_cos(frequency, fs, sin_omega, cos_omega);
+    const float alpha = sin_omega / (2.0f * q);
+
+    float b0 = (1.0f - cos_omega) / 2.0f;
+    float b1 = 1.0f - cos_omega;
+    float b2 = (1.0f - cos_omega) / 2.0f;
+    float a0 = 1.0f + alpha;
+    float a1 = -2.0f * cos_omega;
+    float a2 = 1.0f - alpha;
+
+    return BiquadCoeffs(b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0);
+}
+
+/**
+ * Calculate a notch filter
+ */
+inline BiquadCoeffs calc_notch(float frequency, float q, float fs = 48000.0f) {
+    float sin_omega, cos_omega;
+    omega_sin_cos(frequency, fs, sin_omega, cos_omega);
+    const float alpha = sin_omega / (2.0f * q);
+
+    float b0 = 1.0f;
+    float b1 = -2.0f * cos_omega;
+    float b2 = 1.0f;
+    float a0 = 1.0f + alpha;
+    float a1 = -2.0f * cos_omega;
+    float a2 = 1.0f - alpha;
+
+    return BiquadCoeffs(b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0);
+}
+
+// =============================================================================
+// FILTER DESIGNS
+// =============================================================================
+
+constexpr float REFERENCE_SAMPLE_RATE = 48000.0f;  // Rate of the calc_* defaults and stored coefficients
+
+enum class FilterType : uint8_t {
+    RAW = 0,      // Coefficients only (uploaded or captured), valid at the reference rate
+    PEAKING,
+    LOW_SHELF,
+    HIGH_SHELF,
+    HIGHPASS,
+    LOWPASS,
+    NOTCH,
+};
+
+/**
+ * Design parameters of one biquad, enough to recompute it at any rate
+ */
+struct FilterDesign {
+    FilterType type;
+    float frequency;
+    float gain_db;     // PEAKING and shelves
+    float q;           // Q, or slope for the shelves
+
+    FilterDesign() : type(FilterType::RAW), frequency(0.0f), gain_db(0.0f), q(0.0f) {}
+
+    FilterDesign(FilterType _type, float _frequency, float _gain_db, float _q)
+        : type(_type), frequency(_frequency), gain_db(_gain_db), q(_q) {}
+} __attribute__((packed));
+
+/**
+ * Coefficients of a design at a sample rate
+ *
+ * @return false for RAW, or if the frequency is not below Nyquist at fs
+ *         (the caller keeps the reference-rate coefficients)
+ */
+inline bool calc_filter(const FilterDesign& design, float fs, BiquadCoeffs& out) {
+    if (!(design.frequency > 0.0f) || design.frequency >= fs / 2.0f) return false;
+
+    switch (design.type) {
+        case FilterType::PEAKING:    out = calc_parametric_eq(design.frequency, design.gain_db, design.q, fs); return true;
+        case FilterType::LOW_SHELF:  out = calc_low_shelf(design.frequency, design.gain_db, design.q, fs); return true;
+        case FilterType::HIGH_SHELF: out = calc_high_shelf(design.frequency, design.gain_db, design.q, fs); return true;
+        case FilterType::HIGHPASS:   out = calc_highpass(design.frequency, design.q, fs); return true;
+        case FilterType::LOWPASS:    out = calc_lowpass(design.frequency, design.q, fs); return true;
+        case FilterType::NOTCH:      out = calc_notch(design.frequency, design.q, fs); return true;
+        default:                     return false;
+    }
+}
+
+/**
+ * Validate a design's parameters for its type, and that it can run at fs
+ */
+inline bool validate_design(const FilterDesign& design, float fs) {
+    if (!validate_frequency(design.frequency)) return false;
+    if (design.frequency >= fs / 2.0f) {
+        TAS5805M_BQ_LOGE("Invalid frequency: %.1f Hz (not below Nyquist at %.0f Hz)", design.frequency, fs);
+        return false;
+    }
+
+    switch (design.type) {
+        case FilterType::PEAKING:
+            return validate_gain(design.gain_db) && validate_q(design.q);
+        case FilterType::LOW_SHELF:
+        case FilterType::HIGH_SHELF:
+            return validate_gain(design.gain_db) && validate_slope(design.q);
+        case FilterType::HIGHPASS:
+        case FilterType::LOWPASS:
+        case FilterType::NOTCH:
+            return validate_q(design.q);
+        default:
+            TAS5805M_BQ_LOGE("Invalid filter type: %d", static_cast<int>(design.type));
+            return false;
+    }
+}
+
+}  // namespace tas5805m_biquad
@@ -0,0 +1,308 @@
+/**
+ * TAS5805M Volume-Dependent Loudness Compensation
+ *
+ * Boosts bass and treble as the volume drops, following the equal-loudness
+ * contours: flat at and above a reference volume, full boost at zero. Two
+ * biquads per channel (a low shelf and a high shelf) carry the curve.
+ *
+ * The shelves are designed once per breakpoint when the settings or the
+ * sample rate change, and kept packed. A volume step is then a table lookup
+ * and, when the breakpoint changes, two 20-byte slot updates through the
+ * coefficient writer, whose shadow skips whatever the DSP already holds.
+ * No trig and no full I2C sequence runs on the volume path.
+ *
+ * The shelves take the two highest biquads the profile leaves free (bass
+ * in the lower one), never a slot the profile uses. fit() re-checks them
+ * whenever the profile changes: if the profile now needs a slot, the
+ * shelves move to other free slots, or loudness turns off if there are
+ * fewer than two.
+ *
+ * Breakpoints are evenly spaced over 0 - reference_volume; the default of
+ * 21 matches the media player's 0.05 volume increment at reference 1.0.
+ * Between breakpoints the nearest one is used: steps are at most
+ * bass_max_db / (breakpoints - 1) apart, below what a listener hears while
+ * turning the knob, and every cached set is a designed, stable filter
+ * (blending coefficients of two shelves is not guaranteed to be).
+ *
+ * Pure math like tas5805m_dsp_math.h; the writer is passed in, so the cache
+ * also runs against a fake writer in the host tests.
+ *
+ * Usage:
+ *   auto &cache = tas5805m_loudness::loudness();
+ *   uint16_t released;
+ *   cache.build(tas5805m_loudness::LoudnessSettings(), 48000.0f);
+ *   cache.fit(tas5805m_writer::coeff_writer(), profile.used_slots(), released);
+ *   cache.follow(tas5805m_writer::coeff_writer(), volume);
+ */
+
+#pragma once
+
+#include "tas5805m_dsp_math.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace tas5805m_loudness {
+
+using tas5805m_biquad::BIQUAD_WIRE_BYTES;
+
+// =============================================================================
+// CONSTANTS
+// =============================================================================
+
+constexpr int MAX_BREAKPOINTS = 32;
+constexpr int DEFAULT_BREAKPOINTS = 21;   // One per 0.05 of volume at reference 1.0
+constexpr float MAX_BOOST_DB = 15.0f;     // Per shelf, at zero volume
+
+// =============================================================================
+// DATA STRUCTURES
+// =============================================================================
+
+/**
+ * Loudness curve settings
+ */
+struct LoudnessSettings {
+    float bass_frequency = 100.0f;
+    float bass_max_db = 10.0f;        // Low shelf gain at zero volume
+    float treble_frequency = 10000.0f;
+    float treble_max_db = 4.0f;       // High shelf gain at zero volume
+    float slope = 0.7f;               // Shelf slope (0 - 1]
+    float reference_volume = 0.8f;    // Flat at and above this volume
+    int breakpoints = DEFAULT_BREAKPOINTS;
+};
+
+// =============================================================================
+// LOUDNESS CACHE
+// =============================================================================
+
+class LoudnessCache {
+public:
+    /**
+     * Design and pack the shelves for every breakpoint
+     * @return false (cache left unchanged) for out-of-range settings
+     */
+    bool build(const LoudnessSettings& settings, float fs) {
+        if (!valid(settings, fs)) return false;
+
+        settings_ = settings;
+        const int n = settings.breakpoints;
+        // Breakpoint 0 is exact bypass; a 0 dB shelf only rounds close to it
+        tas5805m_biquad::pack_biquad(tas5805m_biquad::BiquadCoeffs(), wire_[0][0]);
+        tas5805m_biquad::pack_biquad(tas5805m_biquad::BiquadCoeffs(), wire_[0][1]);
+        for (int bp = 1; bp < n; bp++) {
+            float t = static_cast<float>(bp) / static_cast<float>(n - 1);
+            tas5805m_biquad::pack_biquad(
+                tas5805m_biquad::calc_low_shelf(settings.bass_frequency, t * settings.bass_max_db,
+                                                settings.slope, fs),
+                wire_[bp][0]);
+            tas5805m_biquad::pack_biquad(
+                tas5805m_biquad::calc_high_shelf(settings.treble_frequency,
+                                                 t * settings.treble_max_db, settings.slope, fs),
+                wire_[bp][1]);
+        }
+
+        ready_ = true;
+        current_ = -1;  // Next follow() writes, even at an unchanged volume
+        return true;
+    }
+
+    bool ready() const { return ready_; }
+    const LoudnessSettings& settings() const { return settings_; }
+
+    /**
+     * Stop following the volume (the cached sets are dropped)
+     *
+     * The slots stay pinned; the next fit() releases them.
+     */
+    void invalidate() {
+        ready_ = false;
+        current_ = -1;
+    }
+
+    /**
+     * Force the next follow() to write even if the breakpoint is unchanged,
+     * e.g. after something else overwrote the slots
+     */
+    void mark_stale() { current_ = -1; }
+
+    /**
+     * Breakpoint for a volume: 0 at and above the reference, breakpoints - 1 at zero
+     */
+    int breakpoint_for(float volume) const {
+        const int steps = settings_.breakpoints - 1;
+        float t = (settings_.reference_volume - volume) / settings_.reference_volume;
+        if (!(t > 0.0f)) return 0;  // Also catches NaN
+        if (t >= 1.0f) return steps;
+        return static_cast<int>(std::lround(t * steps));
+    }
+
+    /**
+     * Record a volume change
+     * @return the breakpoint to write, or -1 if the slots already hold it
+     */
+    int step(float volume) {
+        last_volume_ = volume;
+        if (!ready_) return -1;
+
+        int bp = breakpoint_for(volume);
+        if (bp == current_) return -1;
+        current_ = bp;
+        return bp;
+    }
+
+    float last_volume() const { return last_volume_; }
+    int current() const { return current_; }
+
+    /**
+     * Packed low shelf (0) or high shelf (1) of a breakpoint
+     */
+    const uint8_t* wire(int bp, int shelf) const { return wire_[bp][shelf]; }
+
+    // =========================================================================
+    // SLOTS
+    // =========================================================================
+
+    int bass_slot() const { return bass_slot_; }
+    int treble_slot() const { return treble_slot_; }
+    bool placed() const { return bass_slot_ >= 0; }
+
+    uint16_t slot_mask() const {
+        return placed() ? static_cast<uint16_t>((1u << bass_slot_) | (1u << treble_slot_)) : 0;
+    }
+
+    /**
+     * True if the shelves are placed and neither slot is in `used`
+     */
+    bool fits(uint16_t used) const { return placed() && (slot_mask() & used) == 0; }
+
+    /**
+     * Pick the two highest slots not in `used` (bass takes the lower one)
+     * @return false (slots left unchanged) if fewer than two are free
+     */
+    bool place(uint16_t used) {
+        int found[2] = {-1, -1};
+        int n = 0;
+        for (int i = static_cast<int>(tas5805m_biquad::BIQUADS_PER_CHANNEL) - 1; i >= 0 && n < 2; i--) {
+            if (!(used & (1u << i))) found[n++] = i;
+        }
+        if (n < 2) return false;
+
+        treble_slot_ = found[0];
+        bass_slot_ = found[1];
+        current_ = -1;
+        return true;
+    }
+
+    /**
+     * Unpin the shelves' slots and forget them
+     *
+     * Writer needs unpin_biquad(channel, index).
+     * @return mask of the released slots, whose contents are the caller's to restore
+     */
+    template<typename Writer>
+    uint16_t release(Writer& writer) {
+        uint16_t released = slot_mask();
+        if (placed()) {
+            writer.unpin_biquad(2, bass_slot_);
+            writer.unpin_biquad(2, treble_slot_);
+        }
+        bass_slot_ = treble_slot_ = -1;
+        current_ = -1;
+        return released;
+    }
+
+    /**
+     * Keep the shelves clear of the profile's slots; call after every
+     * profile change, and after invalidate() to release the slots
+     *
+     * Not ready: releases the slots. Ready and still clear of `used`:
+     * nothing changes. Otherwise the shelves move to the highest free
+     * slots; the next follow() writes them there.
+     *
+     * @param used Slots the profile needs (see CalibrationProfile::used_slots)
+     * @param released Receives the slots given up, to be restored from the profile
+     * @return false if fewer than two slots are free; loudness is then off
+     */
+    template<typename Writer>
+    bool fit(Writer& writer, uint16_t used, uint16_t& released) {
+        released = 0;
+        if (!ready_) {
+            released = release(writer);
+            return true;
+        }
+        if (fits(used)) return true;
+
+        uint16_t previous = release(writer);
+        if (!place(used)) {
+            invalidate();
+            released = previous;
+            return false;
+        }
+        released = previous & ~slot_mask();
+        return true;
+    }
+
+    /**
+     * Pin a breakpoint's shelves into their slots on both channels
+     *
+     * Writer needs pin_biquad(channel, index, const uint8_t* wire) returning
+     * a sequence number (0 = rejected), as tas5805m_writer::CoeffWriter has.
+     * Nothing is written before place() or fit() picked the slots.
+     */
+    template<typename Writer>
+    uint32_t apply(Writer& writer, int bp) {
+        if (!placed()) {
+            current_ = -1;
+            return 0;
+        }
+        uint32_t seq = writer.pin_biquad(2, bass_slot_, wire_[bp][0]);
+        uint32_t treble = writer.pin_biquad(2, treble_slot_, wire_[bp][1]);
+        if (seq == 0 || treble == 0) {
+            current_ = -1;  // Retry on the next volume change
+            return 0;
+        }
+        return treble;
+    }
+
+    /**
+     * Follow a volume change; writes only when the breakpoint moves
+     * @return sequence number of the write, 0 if nothing was written
+     */
+    template<typename Writer>
+    uint32_t follow(Writer& writer, float volume) {
+        int bp = step(volume);
+        if (bp < 0) return 0;
+        return apply(writer, bp);
+    }
+
+private:
+    LoudnessSettings settings_;
+    uint8_t wire_[MAX_BREAKPOINTS][2][BIQUAD_WIRE_BYTES];
+    bool ready_ = false;
+    int current_ = -1;            // Breakpoint the slots hold (-1 = unknown)
+    float last_volume_ = 1.0f;
+    int bass_slot_ = -1;          // Pinned on both channels (-1 = not placed)
+    int treble_slot_ = -1;
+
+    static bool valid(const LoudnessSettings& s, float fs) {
+        const float nyquist = fs / 2.0f;
+        return s.breakpoints >= 2 && s.breakpoints <= MAX_BREAKPOINTS &&
+               s.reference_volume > 0.0f && s.reference_volume <= 1.0f &&
+               s.bass_frequency > 0.0f && s.bass_frequency < nyquist &&
+               s.treble_frequency > 0.0f && s.treble_frequency < nyquist &&
+               std::fabs(s.bass_max_db) <= MAX_BOOST_DB &&
+               std::fabs(s.treble_max_db) <= MAX_BOOST_DB &&
+               s.slope > 0.0f && s.slope <= 1.0f;
+    }
+};
+
+// =============================================================================
+// GLOBAL INSTANCE
+// =============================================================================
+
+static LoudnessCache g_loudness;
+
+inline LoudnessCache& loudness() { return g_loudness; }
+
+}  // namespace tas5805m_loudness
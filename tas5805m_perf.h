@@ -0,0 +1,328 @@
+/**
+ * TAS5805M Hot-Path Instrumentation
+ *
+ * Latency histograms (min/avg/max/p99) and failure counters for the DSP
+ * programming and profile storage paths, plus I2C retry/failure and
+ * circuit-breaker counters.
+ * Recording costs two timer reads and a few increments, without any
+ * logging; results are read by diagnostic sensors or dumped on demand.
+ *
+ * Usage:
+ *   bool select(...) {
+ *       tas5805m_perf::ScopedProbe probe(tas5805m_perf::Probe::SELECT_BOOK_PAGE);
+ *       if (!write(...)) return probe.fail();
+ *       return true;
+ *   }
+ *
+ * Timestamps come from esp_timer (1 us resolution). The CPU cycle counter
+ * is per core and wraps after ~18 s at 240 MHz, and the main loop task is
+ * not pinned to a core, so it can't time operations that block on I2C or
+ * flash.
+ *
+ * Build with -DTAS5805M_PERF_ENABLED=0 to compile all probes out.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#ifndef TAS5805M_PERF_ENABLED
+#define TAS5805M_PERF_ENABLED 1
+#endif
+
+#if defined(ESP_PLATFORM)
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#else
+#include <chrono>
+#endif
+
+namespace tas5805m_perf {
+
+/**
+ * Instrumented operations
+ */
+enum class Probe : uint8_t {
+    SELECT_BOOK_PAGE,     // TAS5805M_I2C::select_book_page (only when registers change)
+    WRITE_BYTES,          // TAS5805M_I2C::write_bytes, retries included
+    WRITE_ALL,            // write_all_biquads_batched / _wire / _atomic (30-biquad sets)
+    LOAD_PROFILE,         // ProfileManager::load_profile_by_index (NVS read + validation)
+    SAVE_PROFILE,         // ProfileManager::save_profile (profile, image and directory)
+    VERIFY,               // verify_all_biquads_wire / verify_coeff_shadow (readback + repair)
+    COUNT
+};
+
+constexpr size_t PROBE_COUNT = static_cast<size_t>(Probe::COUNT);
+
+inline const char* probe_name(Probe probe) {
+    switch (probe) {
+        case Probe::SELECT_BOOK_PAGE:  return "select_book_page";
+        case Probe::WRITE_BYTES:       return "write_bytes";
+        case Probe::WRITE_ALL:         return "write_all";
+        case Probe::LOAD_PROFILE:      return "load_profile";
+        case Probe::SAVE_PROFILE:      return "save_profile";
+        case Probe::VERIFY:            return "verify";
+        default:                       return "?";
+    }
+}
+
+/**
+ * Monotonic microseconds
+ */
+inline uint64_t now_us() {
+#if defined(ESP_PLATFORM)
+    return static_cast<uint64_t>(esp_timer_get_time());
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// =============================================================================
+// HISTOGRAM
+// =============================================================================
+
+// Log-linear buckets: 4 per power of two from 4 us up, exact below 4 us.
+// Bucket width is at most 25% of its value, which bounds the p99 error.
+constexpr int SUB_BUCKET_BITS = 2;
+constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+constexpr int MAX_OCTAVE = 24;                                  // Up to ~33 s
+constexpr size_t HISTOGRAM_BUCKETS = SUB_BUCKETS * (MAX_OCTAVE - SUB_BUCKET_BITS + 2);
+
+inline size_t bucket_for(uint32_t us) {
+    if (us < SUB_BUCKETS) return us;
+
+    int octave = 31 - __builtin_clz(us);
+    if (octave > MAX_OCTAVE) return HISTOGRAM_BUCKETS - 1;
+
+    uint32_t sub = (us >> (octave - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return static_cast<size_t>(SUB_BUCKETS * (octave - SUB_BUCKET_BITS + 1) + sub);
+}
+
+/**
+ * Smallest value that falls into a bucket
+ */
+inline uint32_t bucket_floor(size_t bucket) {
+    if (bucket < SUB_BUCKETS) return static_cast<uint32_t>(bucket);
+
+    int octave = static_cast<int>(bucket / SUB_BUCKETS) + SUB_BUCKET_BITS - 1;
+    uint32_t sub = bucket % SUB_BUCKETS;
+    return (SUB_BUCKETS + sub) << (octave - SUB_BUCKET_BITS);
+}
+
+/**
+ * Latency distribution of one probe
+ */
+struct Histogram {
+    uint32_t count = 0;
+    uint32_t failures = 0;         // Calls that returned an error
+    uint64_t total_us = 0;
+    uint32_t min_us = UINT32_MAX;
+    uint32_t max_us = 0;
+    uint32_t buckets[HISTOGRAM_BUCKETS] = {};
+
+    void record(uint32_t us, bool ok) {
+        count++;
+        if (!ok) failures++;
+        total_us += us;
+        if (us < min_us) min_us = us;
+        if (us > max_us) max_us = us;
+        buckets[bucket_for(us)]++;
+    }
+
+    uint32_t avg_us() const {
+        return count == 0 ? 0 : static_cast<uint32_t>(total_us / count);
+    }
+
+    /**
+     * Upper bound of the bucket holding the given percentile (capped at max)
+     */
+    uint32_t percentile_us(uint32_t percent) const {
+        if (count == 0) return 0;
+
+        // Rank of the sample at the percentile, rounded up
+        uint64_t rank = (static_cast<uint64_t>(count) * percent + 99) / 100;
+        uint64_t seen = 0;
+        for (size_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            seen += buckets[b];
+            if (seen >= rank) {
+                uint32_t upper = (b + 1 < HISTOGRAM_BUCKETS) ? bucket_floor(b + 1) - 1 : max_us;
+                return upper < max_us ? upper : max_us;
+            }
+        }
+        return max_us;
+    }
+
+    uint32_t p99_us() const { return percentile_us(99); }
+};
+
+/**
+ * Bus-level counters, summed over all TAS5805M_I2C transfers
+ */
+struct I2cCounters {
+    uint32_t retries = 0;          // Failed attempts that were retried
+    uint32_t failures = 0;         // Transfers that failed all attempts
+    uint32_t fast_failures = 0;    // Transfers refused by the breaker or an exhausted budget
+    uint32_t breaker_trips = 0;    // Times the circuit breaker opened
+    uint32_t budget_aborts = 0;    // Applies cut short by their failure budget
+};
+
+// =============================================================================
+// GLOBAL STATE
+// =============================================================================
+
+class PerfStats {
+public:
+    void record(Probe probe, uint32_t us, bool ok) {
+        lock();
+        histograms_[static_cast<size_t>(probe)].record(us, ok);
+        unlock();
+    }
+
+    void count_retry() {
+        lock();
+        i2c_.retries++;
+        unlock();
+    }
+
+    void count_failure() {
+        lock();
+        i2c_.failures++;
+        unlock();
+    }
+
+    void count_fast_failure() {
+        lock();
+        i2c_.fast_failures++;
+        unlock();
+    }
+
+    void count_breaker_trip() {
+        lock();
+        i2c_.breaker_trips++;
+        unlock();
+    }
+
+    void count_budget_abort() {
+        lock();
+        i2c_.budget_aborts++;
+        unlock();
+    }
+
+    /**
+     * Consistent copy of one probe's histogram
+     */
+    Histogram snapshot(Probe probe) const {
+        lock();
+        Histogram copy = histograms_[static_cast<size_t>(probe)];
+        unlock();
+        return copy;
+    }
+
+    I2cCounters i2c() const {
+        lock();
+        I2cCounters copy = i2c_;
+        unlock();
+        return copy;
+    }
+
+    void reset() {
+        lock();
+        for (auto& h : histograms_) h = Histogram();
+        i2c_ = I2cCounters();
+        unlock();
+    }
+
+    /**
+     * One-line summary of a probe, e.g. "n=42 min=640us avg=812us max=2301us p99=2047us fail=0"
+     */
+    void format(Probe probe, char* buf, size_t len) const {
+        Histogram h = snapshot(probe);
+        if (h.count == 0) {
+            snprintf(buf, len, "n=0");
+            return;
+        }
+        snprintf(buf, len, "n=%u min=%uus avg=%uus max=%uus p99=%uus fail=%u",
+                 (unsigned)h.count, (unsigned)h.min_us, (unsigned)h.avg_us(), (unsigned)h.max_us,
+                 (unsigned)h.p99_us(), (unsigned)h.failures);
+    }
+
+private:
+    Histogram histograms_[PROBE_COUNT];
+    I2cCounters i2c_;
+
+    // Probes may fire from any task (the main loop, the API). Updates are a few
+    // increments, so a spinlock critical section is cheaper than a mutex.
+#if defined(ESP_PLATFORM)
+    mutable portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;
+    void lock() const { portENTER_CRITICAL(&mux_); }
+    void unlock() const { portEXIT_CRITICAL(&mux_); }
+#else
+    void lock() const {}
+    void unlock() const {}
+#endif
+};
+
+static PerfStats g_perf_stats;
+
+inline PerfStats& perf_stats() { return g_perf_stats; }
+
+// =============================================================================
+// PROBES
+// =============================================================================
+
+#if TAS5805M_PERF_ENABLED
+
+/**
+ * Times the enclosing scope and records it on destruction
+ */
+class ScopedProbe {
+public:
+    explicit ScopedProbe(Probe probe) : probe_(probe), start_us_(now_us()) {}
+
+    ~ScopedProbe() {
+        uint64_t elapsed = now_us() - start_us_;
+        g_perf_stats.record(probe_, elapsed > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(elapsed),
+                            ok_);
+    }
+
+    // Mark the operation failed; returns false so error paths can `return probe.fail();`
+    bool fail() {
+        ok_ = false;
+        return false;
+    }
+
+    ScopedProbe(const ScopedProbe&) = delete;
+    ScopedProbe& operator=(const ScopedProbe&) = delete;
+
+private:
+    Probe probe_;
+    uint64_t start_us_;
+    bool ok_ = true;
+};
+
+inline void count_i2c_retry() { g_perf_stats.count_retry(); }
+inline void count_i2c_failure() { g_perf_stats.count_failure(); }
+inline void count_i2c_fast_failure() { g_perf_stats.count_fast_failure(); }
+inline void count_i2c_breaker_trip() { g_perf_stats.count_breaker_trip(); }
+inline void count_i2c_budget_abort() { g_perf_stats.count_budget_abort(); }
+
+#else
+
+class ScopedProbe {
+public:
+    explicit ScopedProbe(Probe) {}
+    bool fail() { return false; }
+};
+
+inline void count_i2c_retry() {}
+inline void count_i2c_failure() {}
+inline void count_i2c_fast_failure() {}
+inline void count_i2c_breaker_trip() {}
+inline void count_i2c_budget_abort() {}
+
+#endif  // TAS5805M_PERF_ENABLED
+
+}  // namespace tas5805m_perf
@@ -8,6 +8,20 @@
  * - 30 biquad filters (15 per channel)
  * - Metadata (name, timestamp, room name)
  * - Active status
+ *
+ * Profiles are saved in a compact, versioned record: a bitmap of the
+ * non-bypass biquads followed by only those biquads, already in wire form
+ * (9.23 big-endian, a1/a2 inverted). Boot apply streams the stored bytes
+ * without float conversion, and a typical 6-8 band correction fits in
+ * ~200 bytes; stereo-linked sets store one channel. Profiles saved by older
+ * firmware (full float profiles plus a separate wire image) still load, and
+ * are rewritten in the compact format the first time they are applied.
+ *
+ * Slots set from a filter design (PEQ, shelf, pass, notch) also keep the
+ * design parameters, and the record stores the design instead of its
+ * 48 kHz coefficients. A profile can then be regenerated for whatever rate
+ * the I2S bus runs at (RateImageCache); uploaded raw coefficients stay
+ * fixed to the reference rate.
  */
 
 #pragma once
@@ -15,20 +29,32 @@
 #include "esphome/core/preferences.h"
 #include "esphome/core/log.h"
 #include "tas5805m_biquad_i2c.h"
+#include "tas5805m_cascade.h"
+#include "tas5805m_crc32.h"
+#include <cstddef>
 #include <cstring>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 namespace tas5805m_profile {
 
-static const char *TAG = "tas5805m_profile";
-
 // =============================================================================
 // CONSTANTS
 // =============================================================================
 
 constexpr size_t MAX_PROFILE_NAME_LEN = 32;
-constexpr size_t MAX_PROFILES = 5;  // Limit to 5 profiles to save NVS space
+constexpr size_t MAX_PROFILES = 32;  // ~200 bytes each in the compact format
 constexpr uint32_t PROFILE_MAGIC = 0x54415335;  // "TAS5" magic number
+constexpr uint32_t DIRECTORY_MAGIC = 0x54415344;  // "TASD" magic number
+constexpr uint32_t LINKED_PROFILE_MAGIC = 0x5441534C;  // "TASL" magic number
+constexpr uint32_t COMPACT_PROFILE_MAGIC = 0x54415343;  // "TASC" magic number
+constexpr uint8_t COMPACT_VERSION_WIRE = 1;     // Wire entries only
+constexpr uint8_t COMPACT_VERSION_DESIGNS = 2;  // Design mask, then wire and design entries
+constexpr uint8_t FORMAT_LEGACY = 0;  // Directory format: full/linked profile + image
+                                      // (1..n: compact record, size class n - 1)
+constexpr size_t IMAGE_CHANNEL_BYTES =
+    tas5805m_biquad::BIQUADS_PER_CHANNEL * tas5805m_biquad::BIQUAD_WIRE_BYTES;  // 300
 
 // =============================================================================
 // DATA STRUCTURES
@@ -73,6 +99,8 @@ struct CalibrationProfile {
     uint32_t timestamp;                          // Unix timestamp of creation
     BiquadCoefficients left_channel[15];         // Left channel biquads
     BiquadCoefficients right_channel[15];        // Right channel biquads
+    tas5805m_biquad::FilterDesign left_design[15];   // What each left biquad was designed from
+    tas5805m_biquad::FilterDesign right_design[15];  // (RAW: coefficients only)
     uint8_t num_filters_used;                    // Number of non-bypass filters
     uint32_t checksum;                           // CRC32 checksum
 
@@ -87,29 +115,21 @@ struct CalibrationProfile {
 
     // Calculate checksum for validation
     uint32_t calculate_checksum() const {
-        uint32_t crc = 0xFFFFFFFF;
-        const uint8_t* data = reinterpret_cast<const uint8_t*>(this);
-        size_t len = offsetof(CalibrationProfile, checksum);  // Exclude checksum field itself
-
-        for (size_t i = 0; i < len; i++) {
-            crc ^= data[i];
-            for (int j = 0; j < 8; j++) {
-                crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
-            }
-        }
-        return ~crc;
+        // Exclude checksum field itself
+        return tas5805m_crc::crc32(reinterpret_cast<const uint8_t*>(this),
+                                   offsetof(CalibrationProfile, checksum));
     }
 
     // Validate profile integrity
     bool is_valid() const {
         if (magic != PROFILE_MAGIC) {
-            ESP_LOGE(TAG, "Invalid magic: 0x%08X (expected 0x%08X)", magic, PROFILE_MAGIC);
+            TAS5805M_PROFILE_LOGE("Invalid magic: 0x%08X (expected 0x%08X)", magic, PROFILE_MAGIC);
             return false;
         }
 
         uint32_t expected_checksum = calculate_checksum();
         if (checksum != expected_checksum) {
-            ESP_LOGE(TAG, "Checksum mismatch: 0x%08X vs 0x%08X", checksum, expected_checksum);
+            TAS5805M_PROFILE_LOGE("Checksum mismatch: 0x%08X vs 0x%08X", checksum, expected_checksum);
             return false;
         }
 
@@ -130,21 +150,554 @@ struct CalibrationProfile {
             }
         }
     }
+
+    // Bit i set if biquad i is non-bypass on either channel
+    uint16_t used_slots() const {
+        uint16_t used = 0;
+        for (int i = 0; i < 15; i++) {
+            if (!left_channel[i].is_bypass() || !right_channel[i].is_bypass()) {
+                used |= 1u << i;
+            }
+        }
+        return used;
+    }
+
+    // True if both channels hold bit-identical filters
+    bool is_linked() const {
+        return memcmp(left_channel, right_channel, sizeof(left_channel)) == 0 &&
+               memcmp(left_design, right_design, sizeof(left_design)) == 0;
+    }
+
+    /**
+     * Coefficients for a sample rate
+     *
+     * Designed slots are recomputed at fs; RAW slots (and designs at or
+     * above Nyquist) keep their reference-rate coefficients. At the
+     * reference rate the stored coefficients are returned as they are.
+     *
+     * @return number of active slots that could not follow the rate
+     */
+    int coeffs_at_rate(float fs, tas5805m_biquad::BiquadCoeffs left[15],
+                       tas5805m_biquad::BiquadCoeffs right[15]) const {
+        int locked = 0;
+        for (int i = 0; i < 15; i++) {
+            left[i] = left_channel[i].to_coeffs();
+            right[i] = right_channel[i].to_coeffs();
+            if (fs == tas5805m_biquad::REFERENCE_SAMPLE_RATE) continue;
+
+            if (!tas5805m_biquad::calc_filter(left_design[i], fs, left[i]) && !left_channel[i].is_bypass()) locked++;
+            if (!tas5805m_biquad::calc_filter(right_design[i], fs, right[i]) && !right_channel[i].is_bypass()) locked++;
+        }
+        return locked;
+    }
+} __attribute__((packed));
+
+/**
+ * Profile layout written by older firmware (coefficients only)
+ *
+ * Only read; expands to a CalibrationProfile with RAW designs.
+ */
+struct LegacyCalibrationProfile {
+    uint32_t magic;                              // Magic number for validation
+    char name[MAX_PROFILE_NAME_LEN];             // Profile name
+    uint32_t timestamp;                          // Unix timestamp of creation
+    BiquadCoefficients left_channel[15];         // Left channel biquads
+    BiquadCoefficients right_channel[15];        // Right channel biquads
+    uint8_t num_filters_used;                    // Number of non-bypass filters
+    uint32_t checksum;                           // CRC32 checksum
+
+    LegacyCalibrationProfile() : magic(0), timestamp(0), num_filters_used(0), checksum(0) {
+        memset(name, 0, sizeof(name));
+    }
+
+    void expand_to(CalibrationProfile& profile) const {
+        profile = CalibrationProfile();
+        memcpy(profile.name, name, MAX_PROFILE_NAME_LEN);
+        profile.timestamp = timestamp;
+        memcpy(profile.left_channel, left_channel, sizeof(left_channel));
+        memcpy(profile.right_channel, right_channel, sizeof(right_channel));
+        profile.num_filters_used = num_filters_used;
+        profile.update_checksum();
+    }
+
+    uint32_t calculate_checksum() const {
+        return tas5805m_crc::crc32(reinterpret_cast<const uint8_t*>(this),
+                                   offsetof(LegacyCalibrationProfile, checksum));
+    }
+
+    bool is_valid() const {
+        return magic == PROFILE_MAGIC && checksum == calculate_checksum();
+    }
+} __attribute__((packed));
+
+/**
+ * Legacy storage form of a stereo-linked profile: one channel, shared by both
+ *
+ * Only read (new profiles use the compact record). Expands to the
+ * CalibrationProfile it was made from, checksum included.
+ */
+struct LinkedProfile {
+    uint32_t magic;                              // Magic number for validation
+    char name[MAX_PROFILE_NAME_LEN];             // Profile name
+    uint32_t timestamp;                          // Unix timestamp of creation
+    BiquadCoefficients channel[15];              // Biquads for both channels
+    uint8_t num_filters_used;                    // Number of non-bypass filters
+    uint32_t checksum;                           // CRC32 checksum
+
+    LinkedProfile() : magic(0), timestamp(0), num_filters_used(0), checksum(0) {
+        memset(name, 0, sizeof(name));
+    }
+
+    void expand_to(CalibrationProfile& profile) const {
+        profile = CalibrationProfile();
+        memcpy(profile.name, name, MAX_PROFILE_NAME_LEN);
+        profile.timestamp = timestamp;
+        memcpy(profile.left_channel, channel, sizeof(channel));
+        memcpy(profile.right_channel, channel, sizeof(channel));
+        profile.num_filters_used = num_filters_used;
+        profile.update_checksum();
+    }
+
+    uint32_t calculate_checksum() const {
+        return tas5805m_crc::crc32(reinterpret_cast<const uint8_t*>(this), offsetof(LinkedProfile, checksum));
+    }
+
+    bool is_valid() const {
+        return magic == LINKED_PROFILE_MAGIC && checksum == calculate_checksum();
+    }
+} __attribute__((packed));
+
+/**
+ * Directory entry describing one profile slot
+ */
+struct DirectoryEntry {
+    char name[MAX_PROFILE_NAME_LEN];             // Profile name
+    uint32_t timestamp;                          // Copied from the profile
+    uint32_t checksum;                           // Checksum of the stored profile
+    uint8_t num_filters_used;                    // Number of non-bypass filters
+    uint8_t in_use;                              // 1 if the slot holds a profile
+    uint8_t format;                              // FORMAT_LEGACY or compact size class + 1
+
+    DirectoryEntry() : timestamp(0), checksum(0), num_filters_used(0), in_use(0), format(FORMAT_LEGACY) {
+        memset(name, 0, sizeof(name));
+    }
+} __attribute__((packed));
+
+/**
+ * Index of all profile slots, kept in a single NVS key
+ *
+ * Lookups and listing only consult this record (cached in RAM after
+ * setup), so the periodic text sensors never read full profiles.
+ */
+struct ProfileDirectory {
+    uint32_t magic;                              // Magic number for validation
+    DirectoryEntry entries[MAX_PROFILES];        // Indexed by slot
+    uint32_t checksum;                           // CRC32 checksum
+
+    ProfileDirectory() : magic(DIRECTORY_MAGIC), checksum(0) {}
+
+    uint32_t calculate_checksum() const {
+        return tas5805m_crc::crc32(reinterpret_cast<const uint8_t*>(this), offsetof(ProfileDirectory, checksum));
+    }
+
+    bool is_valid() const {
+        return magic == DIRECTORY_MAGIC && checksum == calculate_checksum();
+    }
+
+    void update_checksum() {
+        checksum = calculate_checksum();
+    }
+} __attribute__((packed));
+
+// =============================================================================
+// COMPACT STORAGE
+// =============================================================================
+
+/**
+ * Payload capacities of the compact record sizes, in 20-byte wire biquads
+ *
+ * NVS entries have a fixed size per type, so a record uses the smallest
+ * class that fits; the directory remembers which one.
+ */
+constexpr size_t COMPACT_CAPACITIES[] = {4, 8, 12, 16, 20, 30};
+constexpr size_t COMPACT_SIZE_CLASSES = sizeof(COMPACT_CAPACITIES) / sizeof(COMPACT_CAPACITIES[0]);
+constexpr size_t COMPACT_MAX_STORED = 2 * tas5805m_biquad::BIQUADS_PER_CHANNEL;
+constexpr size_t COMPACT_PAYLOAD_MAX = COMPACT_MAX_STORED * tas5805m_biquad::BIQUAD_WIRE_BYTES;  // 600
+constexpr size_t COMPACT_DESIGN_MASK_BYTES = 2 * sizeof(uint16_t);
+constexpr size_t COMPACT_DESIGN_BYTES = sizeof(tas5805m_biquad::FilterDesign);                 // 13
+
+// Version 1 is written when no slot has a design, so a full 30-biquad
+// set still fits; with one design the mask costs less than it saves
+static_assert(COMPACT_DESIGN_MASK_BYTES + (COMPACT_MAX_STORED - 1) * tas5805m_biquad::BIQUAD_WIRE_BYTES +
+              COMPACT_DESIGN_BYTES <= COMPACT_PAYLOAD_MAX, "version 2 payload must fit the largest class");
+
+constexpr uint8_t COMPACT_FLAG_LINKED = 0x01;  // One channel stored, used for both
+
+/**
+ * Fixed part of a compact record
+ */
+struct CompactProfileHeader {
+    uint32_t magic;                              // COMPACT_PROFILE_MAGIC
+    uint8_t version;                             // COMPACT_VERSION_*
+    uint8_t flags;                               // COMPACT_FLAG_*
+    uint8_t num_filters_used;                    // Number of non-bypass filters
+    uint8_t stored;                              // Entries in the payload
+    char name[MAX_PROFILE_NAME_LEN];             // Profile name
+    uint32_t timestamp;                          // Unix timestamp of creation
+    uint16_t mask[2];                            // Bit i = biquad i stored, per channel
+
+    CompactProfileHeader() : magic(0), version(0), flags(0), num_filters_used(0), stored(0), timestamp(0) {
+        memset(name, 0, sizeof(name));
+        mask[0] = mask[1] = 0;
+    }
 } __attribute__((packed));
 
+/**
+ * Bytes a payload uses (SIZE_MAX if the header is not one this firmware reads)
+ */
+inline size_t compact_payload_bytes(const CompactProfileHeader& header, const uint8_t* payload) {
+    if (header.stored > COMPACT_MAX_STORED) return SIZE_MAX;
+    if (header.version == COMPACT_VERSION_WIRE) return header.stored * tas5805m_biquad::BIQUAD_WIRE_BYTES;
+    if (header.version != COMPACT_VERSION_DESIGNS) return SIZE_MAX;
+
+    uint16_t design_mask[2];
+    memcpy(design_mask, payload, sizeof(design_mask));
+    size_t designs = __builtin_popcount(design_mask[0] & header.mask[0]);
+    if (!(header.flags & COMPACT_FLAG_LINKED)) designs += __builtin_popcount(design_mask[1] & header.mask[1]);
+    if (designs > header.stored) return SIZE_MAX;
+
+    return COMPACT_DESIGN_MASK_BYTES + designs * COMPACT_DESIGN_BYTES +
+           (header.stored - designs) * tas5805m_biquad::BIQUAD_WIRE_BYTES;
+}
+
+/**
+ * Compact record with room for CAPACITY wire biquads
+ *
+ * Payload, version 1: the stored biquads in wire form (9.23 big-endian,
+ * a1/a2 inverted), left channel first, ascending index.
+ * Version 2: a uint16_t[2] mask of the stored biquads kept as designs,
+ * then the same entries in the same order, each either 20 wire bytes or a
+ * 13-byte FilterDesign. Unused capacity is zero.
+ */
+template<size_t CAPACITY>
+struct CompactProfileRecord {
+    CompactProfileHeader header;
+    uint8_t payload[CAPACITY * tas5805m_biquad::BIQUAD_WIRE_BYTES];
+    uint32_t checksum;                           // CRC32 checksum
+
+    CompactProfileRecord() : checksum(0) {
+        memset(payload, 0, sizeof(payload));
+    }
+
+    uint32_t calculate_checksum() const {
+        return tas5805m_crc::crc32(reinterpret_cast<const uint8_t*>(this), offsetof(CompactProfileRecord, checksum));
+    }
+
+    bool is_valid() const {
+        return header.magic == COMPACT_PROFILE_MAGIC && checksum == calculate_checksum() &&
+               compact_payload_bytes(header, payload) <= sizeof(payload);
+    }
+} __attribute__((packed));
+
+/**
+ * Packed bypass biquad (b0 = 1, rest 0)
+ */
+inline const uint8_t* bypass_wire() {
+    static uint8_t wire[tas5805m_biquad::BIQUAD_WIRE_BYTES];
+    static bool packed = false;
+    if (!packed) {
+        tas5805m_biquad::pack_biquad(tas5805m_biquad::BiquadCoeffs(), wire);
+        packed = true;
+    }
+    return wire;
+}
+
+/**
+ * True if a design recomputes exactly these wire bytes at the reference rate
+ *
+ * Deterministic: calc_filter takes its sin/cos from the trig cache, whose
+ * seeds and misses compute the same way, so the answer doesn't depend on
+ * which frequencies were designed before.
+ */
+inline bool design_reproduces(const tas5805m_biquad::FilterDesign& design, const uint8_t* wire) {
+    tas5805m_biquad::BiquadCoeffs coeffs;
+    if (!tas5805m_biquad::calc_filter(design, tas5805m_biquad::REFERENCE_SAMPLE_RATE, coeffs)) return false;
+
+    uint8_t packed[tas5805m_biquad::BIQUAD_WIRE_BYTES];
+    tas5805m_biquad::pack_biquad(coeffs, packed);
+    return memcmp(packed, wire, sizeof(packed)) == 0;
+}
+
+/**
+ * Encode a profile: header plus its non-bypass biquads
+ *
+ * A biquad counts as bypass only if it packs to exactly the bypass bytes,
+ * so the chip receives the same coefficients as from the float profile.
+ * A biquad whose design reproduces it bit for bit is stored as the design,
+ * which is smaller and can be recomputed at another rate; a design that
+ * no longer matches its coefficients (edited raw) is not trusted and is
+ * dropped with a warning, since that slot then stays at its reference-rate
+ * coefficients when the sample rate changes.
+ *
+ * @param payload Receives up to COMPACT_PAYLOAD_MAX bytes
+ * @return payload bytes used
+ */
+inline size_t compact_encode(const CalibrationProfile& profile, CompactProfileHeader& header, uint8_t* payload) {
+    header = CompactProfileHeader();
+    header.magic = COMPACT_PROFILE_MAGIC;
+    header.flags = profile.is_linked() ? COMPACT_FLAG_LINKED : 0;
+    header.num_filters_used = profile.num_filters_used;
+    memcpy(header.name, profile.name, MAX_PROFILE_NAME_LEN);
+    header.timestamp = profile.timestamp;
+
+    uint8_t wire[COMPACT_MAX_STORED][tas5805m_biquad::BIQUAD_WIRE_BYTES];
+    const tas5805m_biquad::FilterDesign* designs[COMPACT_MAX_STORED];
+    uint16_t design_mask[2] = {0, 0};
+
+    int channels = (header.flags & COMPACT_FLAG_LINKED) ? 1 : 2;
+    for (int ch = 0; ch < channels; ch++) {
+        const BiquadCoefficients* coeffs = (ch == 0) ? profile.left_channel : profile.right_channel;
+        const tas5805m_biquad::FilterDesign* design = (ch == 0) ? profile.left_design : profile.right_design;
+        for (size_t i = 0; i < tas5805m_biquad::BIQUADS_PER_CHANNEL; i++) {
+            uint8_t* out = wire[header.stored];
+            tas5805m_biquad::pack_biquad(coeffs[i].to_coeffs(), out);
+            if (memcmp(out, bypass_wire(), tas5805m_biquad::BIQUAD_WIRE_BYTES) == 0) continue;
+
+            designs[header.stored] = design_reproduces(design[i], out) ? &design[i] : nullptr;
+            if (designs[header.stored] != nullptr) {
+                design_mask[ch] |= 1u << i;
+            } else if (design[i].type != tas5805m_biquad::FilterType::RAW) {
+                TAS5805M_PROFILE_LOGW("'%s' ch%d biquad %u: design doesn't reproduce its coefficients, "
+                                      "stored raw (fixed at the reference rate)",
+                                      profile.name, ch, static_cast<unsigned>(i));
+            }
+            header.mask[ch] |= 1u << i;
+            header.stored++;
+        }
+    }
+    if (channels == 1) {
+        header.mask[1] = header.mask[0];
+        design_mask[1] = design_mask[0];
+    }
+
+    size_t bytes = 0;
+    header.version = (design_mask[0] | design_mask[1]) ? COMPACT_VERSION_DESIGNS : COMPACT_VERSION_WIRE;
+    if (header.version == COMPACT_VERSION_DESIGNS) {
+        memcpy(payload, design_mask, sizeof(design_mask));
+        bytes = sizeof(design_mask);
+    }
+    for (size_t k = 0; k < header.stored; k++) {
+        if (designs[k] != nullptr) {
+            memcpy(&payload[bytes], designs[k], COMPACT_DESIGN_BYTES);
+            bytes += COMPACT_DESIGN_BYTES;
+        } else {
+            memcpy(&payload[bytes], wire[k], tas5805m_biquad::BIQUAD_WIRE_BYTES);
+            bytes += tas5805m_biquad::BIQUAD_WIRE_BYTES;
+        }
+    }
+    return bytes;
+}
+
+/**
+ * Expand a compact payload to both channels' wire images at a sample rate
+ *
+ * Designs are computed at fs; wire entries, and designs at or above
+ * Nyquist at fs, keep their reference-rate coefficients.
+ *
+ * @param designs Receives each slot's design (RAW where none), or nullptr
+ * @return number of stored biquads that could not follow fs (per channel)
+ */
+inline int compact_expand(const CompactProfileHeader& header, const uint8_t* payload, float fs,
+                          uint8_t (&wire)[2][IMAGE_CHANNEL_BYTES],
+                          tas5805m_biquad::FilterDesign (*designs)[tas5805m_biquad::BIQUADS_PER_CHANNEL] = nullptr) {
+    uint16_t design_mask[2] = {0, 0};
+    size_t start = 0;
+    if (header.version == COMPACT_VERSION_DESIGNS) {
+        memcpy(design_mask, payload, sizeof(design_mask));
+        start = sizeof(design_mask);
+    }
+
+    const bool reference = (fs == tas5805m_biquad::REFERENCE_SAMPLE_RATE);
+    int locked = 0;
+    size_t offset = start;
+    for (int ch = 0; ch < 2; ch++) {
+        // A linked record replays the left biquads for the right channel
+        if (ch == 1 && (header.flags & COMPACT_FLAG_LINKED)) offset = start;
+
+        for (size_t i = 0; i < tas5805m_biquad::BIQUADS_PER_CHANNEL; i++) {
+            uint8_t* out = &wire[ch][i * tas5805m_biquad::BIQUAD_WIRE_BYTES];
+            const uint16_t bit = 1u << i;
+            tas5805m_biquad::FilterDesign design;
+
+            if (!(header.mask[ch] & bit)) {
+                memcpy(out, bypass_wire(), tas5805m_biquad::BIQUAD_WIRE_BYTES);
+            } else if (design_mask[ch] & bit) {
+                memcpy(&design, &payload[offset], COMPACT_DESIGN_BYTES);
+                offset += COMPACT_DESIGN_BYTES;
+
+                tas5805m_biquad::BiquadCoeffs coeffs;
+                if (!tas5805m_biquad::calc_filter(design, fs, coeffs)) {
+                    tas5805m_biquad::calc_filter(design, tas5805m_biquad::REFERENCE_SAMPLE_RATE, coeffs);
+                    if (!reference) locked++;
+                }
+                tas5805m_biquad::pack_biquad(coeffs, out);
+            } else {
+                memcpy(out, &payload[offset], tas5805m_biquad::BIQUAD_WIRE_BYTES);
+                offset += tas5805m_biquad::BIQUAD_WIRE_BYTES;
+                if (!reference) locked++;
+            }
+
+            if (designs != nullptr) designs[ch][i] = design;
+        }
+    }
+    return locked;
+}
+
+/**
+ * Expand a compact payload to both channels' wire images
+ */
+inline int compact_expand_wire(const CompactProfileHeader& header, const uint8_t* payload,
+                               uint8_t (&wire)[2][IMAGE_CHANNEL_BYTES],
+                               float fs = tas5805m_biquad::REFERENCE_SAMPLE_RATE) {
+    return compact_expand(header, payload, fs, wire);
+}
+
+/**
+ * Rebuild the float profile from reference-rate wire images (checksum recomputed)
+ */
+inline void compact_to_profile(const CompactProfileHeader& header,
+                               const uint8_t (&wire)[2][IMAGE_CHANNEL_BYTES],
+                               const tas5805m_biquad::FilterDesign (&designs)[2][tas5805m_biquad::BIQUADS_PER_CHANNEL],
+                               CalibrationProfile& profile) {
+    profile.magic = PROFILE_MAGIC;
+    memcpy(profile.name, header.name, MAX_PROFILE_NAME_LEN);
+    profile.timestamp = header.timestamp;
+    for (size_t i = 0; i < tas5805m_biquad::BIQUADS_PER_CHANNEL; i++) {
+        profile.left_channel[i] = tas5805m_biquad::unpack_biquad(&wire[0][i * tas5805m_biquad::BIQUAD_WIRE_BYTES]);
+        profile.right_channel[i] = tas5805m_biquad::unpack_biquad(&wire[1][i * tas5805m_biquad::BIQUAD_WIRE_BYTES]);
+    }
+    memcpy(profile.left_design, designs[0], sizeof(profile.left_design));
+    memcpy(profile.right_design, designs[1], sizeof(profile.right_design));
+    profile.num_filters_used = header.num_filters_used;
+    profile.update_checksum();
+}
+
+/**
+ * Smallest size class holding a payload of `bytes` (1-based directory format)
+ */
+inline uint8_t compact_format_for(size_t bytes) {
+    for (size_t c = 0; c < COMPACT_SIZE_CLASSES; c++) {
+        if (bytes <= COMPACT_CAPACITIES[c] * tas5805m_biquad::BIQUAD_WIRE_BYTES) return static_cast<uint8_t>(c + 1);
+    }
+    return static_cast<uint8_t>(COMPACT_SIZE_CLASSES);
+}
+
+/**
+ * Decode a compact payload into a float profile (checksum recomputed)
+ */
+inline void compact_decode(const CompactProfileHeader& header, const uint8_t* payload,
+                           CalibrationProfile& profile) {
+    uint8_t wire[2][IMAGE_CHANNEL_BYTES];
+    tas5805m_biquad::FilterDesign designs[2][tas5805m_biquad::BIQUADS_PER_CHANNEL];
+    compact_expand(header, payload, tas5805m_biquad::REFERENCE_SAMPLE_RATE, wire, designs);
+    compact_to_profile(header, wire, designs, profile);
+}
+
+// =============================================================================
+// RATE IMAGE CACHE
+// =============================================================================
+
+using WireImage = uint8_t[2][IMAGE_CHANNEL_BYTES];
+
+/**
+ * Wire images of a profile regenerated for the I2S sample rate
+ *
+ * A rate change redesigns every designed slot and packs both channels;
+ * streams that alternate between a few rates reuse the result instead.
+ * Entries are keyed by the profile's content checksum (computed here, so
+ * edits to the shadow miss rather than replay old coefficients) and the
+ * rate, and the least recently used one is replaced. Main loop only.
+ */
+class RateImageCache {
+public:
+    static constexpr size_t ENTRIES = 3;         // e.g. 44.1, 48 and 96 kHz
+
+    /**
+     * Image of profile at fs, computed on a miss
+     *
+     * @param rate_locked Receives the number of active slots stuck at the reference rate
+     */
+    const WireImage& image_for(const CalibrationProfile& profile, float fs, int* rate_locked = nullptr) {
+        const uint32_t key = profile.calculate_checksum();
+        clock_++;
+
+        Entry* victim = nullptr;
+        for (Entry& entry : entries_) {
+            if (entry.valid && entry.key == key && entry.fs == fs) {
+                hits_++;
+                entry.last_used = clock_;
+                if (rate_locked != nullptr) *rate_locked = entry.rate_locked;
+                return entry.wire;
+            }
+            // Free entries first, then the least recently used
+            if (victim == nullptr || (victim->valid && (!entry.valid || entry.last_used < victim->last_used))) {
+                victim = &entry;
+            }
+        }
+
+        misses_++;
+        tas5805m_biquad::BiquadCoeffs left[15];
+        tas5805m_biquad::BiquadCoeffs right[15];
+        victim->rate_locked = profile.coeffs_at_rate(fs, left, right);
+        tas5805m_biquad::pack_channels(left, right, victim->wire);
+        victim->key = key;
+        victim->fs = fs;
+        victim->last_used = clock_;
+        victim->valid = true;
+
+        if (rate_locked != nullptr) *rate_locked = victim->rate_locked;
+        return victim->wire;
+    }
+
+    void clear() {
+        for (Entry& entry : entries_) entry.valid = false;
+    }
+
+    uint32_t hits() const { return hits_; }
+    uint32_t misses() const { return misses_; }
+
+private:
+    struct Entry {
+        uint32_t key = 0;
+        float fs = 0.0f;
+        uint32_t last_used = 0;
+        int rate_locked = 0;
+        bool valid = false;
+        WireImage wire;
+    };
+
+    Entry entries_[ENTRIES];
+    uint32_t clock_ = 0;
+    uint32_t hits_ = 0;
+    uint32_t misses_ = 0;
+};
+
 // =============================================================================
 // PROFILE MANAGER CLASS
 // =============================================================================
 
+// Defined with the global instances below
+inline CalibrationProfile& current_profile_shadow();
+
 class ProfileManager {
 public:
-    ProfileManager() : active_profile_index_(-1) {}
+    ProfileManager() : active_profile_index_(-1), directory_saved_checksum_(0), batch_depth_(0), batch_dirty_(false) {}
 
     /**
      * Initialize the profile manager
      */
     void setup() {
-        ESP_LOGI(TAG, "Initializing profile manager");
+        TAS5805M_PROFILE_LOGI("Initializing profile manager");
 
         // Load active profile index
         active_pref_ = esphome::global_preferences->make_preference<int8_t>(
@@ -152,30 +705,44 @@ public:
         );
 
         if (active_pref_.load(&active_profile_index_)) {
-            if (active_profile_index_ >= 0 && active_profile_index_ < MAX_PROFILES) {
-                ESP_LOGI(TAG, "Active profile index: %d", active_profile_index_);
+            if (active_profile_index_ >= 0 && active_profile_index_ < static_cast<int>(MAX_PROFILES)) {
+                TAS5805M_PROFILE_LOGI("Active profile index: %d", active_profile_index_);
             } else {
-                ESP_LOGW(TAG, "Invalid active profile index: %d, resetting", active_profile_index_);
+                TAS5805M_PROFILE_LOGW("Invalid active profile index: %d, resetting", active_profile_index_);
                 active_profile_index_ = -1;
             }
         } else {
-            ESP_LOGI(TAG, "No active profile set");
+            TAS5805M_PROFILE_LOGI("No active profile set");
             active_profile_index_ = -1;
         }
+
+        // Load the profile directory (rebuilt once from the slots if missing)
+        directory_pref_ = esphome::global_preferences->make_preference<ProfileDirectory>(
+            fnv1_hash("profile_dir")
+        );
+
+        if (directory_pref_.load(&directory_) && directory_.is_valid()) {
+            directory_saved_checksum_ = directory_.checksum;
+        } else {
+            TAS5805M_PROFILE_LOGI("Rebuilding profile directory");
+            StorageBatch batch(*this);
+            rebuild_directory();
+        }
     }
 
     /**
      * Save a calibration profile
      */
     bool save_profile(const std::string& profile_name, const CalibrationProfile& profile) {
+        tas5805m_perf::ScopedProbe probe(tas5805m_perf::Probe::SAVE_PROFILE);
+
         // Find existing profile or empty slot
         int slot = find_profile_slot(profile_name);
 
         if (slot == -1) {
             // Find empty slot
-            for (int i = 0; i < MAX_PROFILES; i++) {
-                CalibrationProfile temp;
-                if (!load_profile_by_index(i, temp)) {
+            for (int i = 0; i < static_cast<int>(MAX_PROFILES); i++) {
+                if (!directory_.entries[i].in_use) {
                     slot = i;
                     break;
                 }
@@ -183,8 +750,8 @@ public:
         }
 
         if (slot == -1) {
-            ESP_LOGE(TAG, "No available profile slots (max %d)", MAX_PROFILES);
-            return false;
+            TAS5805M_PROFILE_LOGE("No available profile slots (max %d)", static_cast<int>(MAX_PROFILES));
+            return probe.fail();
         }
 
         // Prepare profile for saving
@@ -193,21 +760,11 @@ public:
         save_profile.name[MAX_PROFILE_NAME_LEN - 1] = '\0';
         save_profile.timestamp = esphome::millis() / 1000;  // Approximate unix timestamp
         save_profile.count_active_filters();
-        save_profile.update_checksum();
-
-        // Save to NVS
-        auto pref = esphome::global_preferences->make_preference<CalibrationProfile>(
-            fnv1_hash(get_profile_key(slot).c_str())
-        );
-
-        if (!pref.save(&save_profile)) {
-            ESP_LOGE(TAG, "Failed to save profile to slot %d", slot);
-            return false;
-        }
-
-        ESP_LOGI(TAG, "Saved profile '%s' to slot %d (%d filters)",
-                 profile_name.c_str(), slot, save_profile.num_filters_used);
 
+        // Record and directory go out in one commit
+        StorageBatch batch(*this);
+        if (!store_compact(slot, save_profile)) return probe.fail();
+        if (!save_directory()) return probe.fail();
         return true;
     }
 
@@ -217,7 +774,7 @@ public:
     bool load_profile(const std::string& profile_name, CalibrationProfile& profile) {
         int slot = find_profile_slot(profile_name);
         if (slot == -1) {
-            ESP_LOGE(TAG, "Profile '%s' not found", profile_name.c_str());
+            TAS5805M_PROFILE_LOGE("Profile '%s' not found", profile_name.c_str());
             return false;
         }
 
@@ -226,27 +783,28 @@ public:
 
     /**
      * Load a calibration profile by index
+     *
+     * Reads only the slot's record, sized from its directory entry.
      */
     bool load_profile_by_index(int slot, CalibrationProfile& profile) {
-        if (slot < 0 || slot >= MAX_PROFILES) {
-            ESP_LOGE(TAG, "Invalid profile slot: %d", slot);
+        if (slot < 0 || slot >= static_cast<int>(MAX_PROFILES)) {
+            TAS5805M_PROFILE_LOGE("Invalid profile slot: %d", slot);
             return false;
         }
 
-        auto pref = esphome::global_preferences->make_preference<CalibrationProfile>(
-            fnv1_hash(get_profile_key(slot).c_str())
-        );
-
-        if (!pref.load(&profile)) {
-            return false;
+        const DirectoryEntry& entry = directory_.entries[slot];
+        if (!entry.in_use) {
+            return false;  // Empty slot; not counted as a failure
         }
 
-        if (!profile.is_valid()) {
-            ESP_LOGE(TAG, "Profile in slot %d failed validation", slot);
-            return false;
+        tas5805m_perf::ScopedProbe probe(tas5805m_perf::Probe::LOAD_PROFILE);
+
+        if (!read_slot(slot, entry.format, profile)) {
+            TAS5805M_PROFILE_LOGE("Profile in slot %d failed validation", slot);
+            return probe.fail();
         }
 
-        ESP_LOGI(TAG, "Loaded profile '%s' from slot %d (%d filters)",
+        TAS5805M_PROFILE_LOGI("Loaded profile '%s' from slot %d (%d filters)",
                  profile.name, slot, profile.num_filters_used);
 
         return true;
@@ -254,30 +812,30 @@ public:
 
     /**
      * Delete a profile by name
+     *
+     * Only the directory entry is cleared: the slot's record stays in NVS
+     * until the slot is reused, but nothing reads a slot the directory marks
+     * free. (A directory rebuild after corruption can bring it back.)
      */
     bool delete_profile(const std::string& profile_name) {
         int slot = find_profile_slot(profile_name);
         if (slot == -1) {
-            ESP_LOGE(TAG, "Profile '%s' not found", profile_name.c_str());
+            TAS5805M_PROFILE_LOGE("Profile '%s' not found", profile_name.c_str());
             return false;
         }
 
-        // Clear the NVS entry
-        auto pref = esphome::global_preferences->make_preference<CalibrationProfile>(
-            fnv1_hash(get_profile_key(slot).c_str())
-        );
+        // Directory and active index go out in one commit
+        StorageBatch batch(*this);
 
-        // ESPHome doesn't have a delete function, so we save an invalid profile
-        CalibrationProfile empty;
-        empty.magic = 0;  // Invalid magic
-        pref.save(&empty);
+        directory_.entries[slot] = DirectoryEntry();
+        save_directory();
 
         // If this was the active profile, clear active status
         if (slot == active_profile_index_) {
             set_active_profile(-1);
         }
 
-        ESP_LOGI(TAG, "Deleted profile '%s' from slot %d", profile_name.c_str(), slot);
+        TAS5805M_PROFILE_LOGI("Deleted profile '%s' from slot %d", profile_name.c_str(), slot);
         return true;
     }
 
@@ -287,14 +845,13 @@ public:
     std::vector<std::string> list_profiles() {
         std::vector<std::string> profiles;
 
-        for (int i = 0; i < MAX_PROFILES; i++) {
-            CalibrationProfile profile;
-            if (load_profile_by_index(i, profile)) {
-                profiles.push_back(std::string(profile.name));
+        for (int i = 0; i < static_cast<int>(MAX_PROFILES); i++) {
+            if (directory_.entries[i].in_use) {
+                profiles.push_back(std::string(directory_.entries[i].name));
             }
         }
 
-        ESP_LOGI(TAG, "Found %d profiles", profiles.size());
+        TAS5805M_PROFILE_LOGD("Found %d profiles", (int)profiles.size());
         return profiles;
     }
 
@@ -304,7 +861,7 @@ public:
     bool set_active_profile(const std::string& profile_name) {
         int slot = find_profile_slot(profile_name);
         if (slot == -1) {
-            ESP_LOGE(TAG, "Profile '%s' not found", profile_name.c_str());
+            TAS5805M_PROFILE_LOGE("Profile '%s' not found", profile_name.c_str());
             return false;
         }
 
@@ -315,22 +872,28 @@ public:
      * Set active profile by index
      */
     bool set_active_profile(int slot) {
-        if (slot >= MAX_PROFILES) {
-            ESP_LOGE(TAG, "Invalid profile slot: %d", slot);
+        if (slot < -1 || slot >= static_cast<int>(MAX_PROFILES)) {  // -1 clears
+            TAS5805M_PROFILE_LOGE("Invalid profile slot: %d", slot);
             return false;
         }
 
+        if (slot == active_profile_index_) {
+            TAS5805M_PROFILE_LOGD("Active profile unchanged (slot %d)", slot);
+            return true;
+        }
+
         active_profile_index_ = slot;
 
-        if (!active_pref_.save(&active_profile_index_)) {
-            ESP_LOGE(TAG, "Failed to save active profile index");
+        StorageBatch batch(*this);
+        if (!write_pref(active_pref_, active_profile_index_)) {
+            TAS5805M_PROFILE_LOGE("Failed to save active profile index");
             return false;
         }
 
         if (slot == -1) {
-            ESP_LOGI(TAG, "Cleared active profile");
+            TAS5805M_PROFILE_LOGI("Cleared active profile");
         } else {
-            ESP_LOGI(TAG, "Set active profile to slot %d", slot);
+            TAS5805M_PROFILE_LOGI("Set active profile to slot %d", slot);
         }
 
         return true;
@@ -344,9 +907,9 @@ public:
             return "none";
         }
 
-        CalibrationProfile profile;
-        if (load_profile_by_index(active_profile_index_, profile)) {
-            return std::string(profile.name);
+        const DirectoryEntry& entry = directory_.entries[active_profile_index_];
+        if (entry.in_use) {
+            return std::string(entry.name);
         }
 
         return "error";
@@ -355,49 +918,359 @@ public:
     /**
      * Load and apply the active profile on boot
      *
-     * Uses batched I2C writes for performance:
-     *   - Old method: ~150+ I2C transactions, 150ms+ delays
-     *   - Batched: ~24 I2C transactions, ~30ms delays
+     * Compact records are expanded straight into wire images, without float
+     * conversion. Profiles saved by older firmware take the float path once
+     * and are rewritten in the compact format for the next boot.
+     *
+     * Uses delta writes against the coefficient shadow: only biquads that
+     * differ from what the DSP already holds are sent, so re-applying the
+     * profile that is already loaded costs no I2C traffic.
+     *
+     * On success the applied profile also becomes current_profile_shadow(),
+     * which the services edit, re-rate and optimize; otherwise the first
+     * rate change or loudness placement after a reboot would work from an
+     * empty profile. The compact record is decoded after the write, so the
+     * float conversion doesn't delay the correction.
+     *
+     * @param fs Sample rate the DSP runs at; designed slots are computed for it
      */
-    bool load_and_apply_active_profile(esphome::i2c::I2CBus* bus, uint8_t address) {
+    bool load_and_apply_active_profile(esphome::i2c::I2CBus* bus, uint8_t address,
+                                       float fs = tas5805m_biquad::REFERENCE_SAMPLE_RATE) {
         if (active_profile_index_ == -1) {
-            ESP_LOGI(TAG, "No active profile to load");
+            TAS5805M_PROFILE_LOGI("No active profile to load");
             return true;  // Not an error
         }
 
+        const DirectoryEntry& entry = directory_.entries[active_profile_index_];
+        if (entry.in_use && entry.format != FORMAT_LEGACY) {
+            CompactProfileHeader header;
+            uint8_t payload[COMPACT_PAYLOAD_MAX];
+            if (!read_compact(active_profile_index_, entry.format, header, payload)) {
+                TAS5805M_PROFILE_LOGE("Failed to load active profile");
+                return false;
+            }
+
+            uint8_t wire[2][IMAGE_CHANNEL_BYTES];
+            int locked = compact_expand_wire(header, payload, wire, fs);
+            if (locked > 0) {
+                TAS5805M_PROFILE_LOGW("%d biquad(s) of '%s' have no design and stay at %.0f Hz",
+                                      locked, entry.name, tas5805m_biquad::REFERENCE_SAMPLE_RATE);
+            }
+
+            TAS5805M_PROFILE_LOGI("Applying active profile '%s' (%d stored biquads, %.0f Hz)",
+                                  entry.name, header.stored, fs);
+            bool written = (header.flags & COMPACT_FLAG_LINKED)
+                               ? tas5805m_biquad::write_all_biquads_wire_linked(bus, address, wire[0])
+                               : tas5805m_biquad::write_all_biquads_wire(bus, address, wire);
+            if (written) compact_decode(header, payload, current_profile_shadow());
+            return written;
+        }
+
         CalibrationProfile profile;
         if (!load_profile_by_index(active_profile_index_, profile)) {
-            ESP_LOGE(TAG, "Failed to load active profile");
+            TAS5805M_PROFILE_LOGE("Failed to load active profile");
             return false;
         }
 
-        ESP_LOGI(TAG, "Applying active profile '%s' (batched)", profile.name);
+        TAS5805M_PROFILE_LOGI("Applying active profile '%s' (delta)", profile.name);
 
-        // Convert profile coefficients to biquad library format
+        // Convert profile coefficients to biquad library format (legacy
+        // profiles have no designs, so this is the reference set)
         tas5805m_biquad::BiquadCoeffs left_coeffs[15];
         tas5805m_biquad::BiquadCoeffs right_coeffs[15];
+        profile.coeffs_at_rate(fs, left_coeffs, right_coeffs);
 
-        for (int i = 0; i < 15; i++) {
-            left_coeffs[i] = profile.left_channel[i].to_coeffs();
-            right_coeffs[i] = profile.right_channel[i].to_coeffs();
-        }
-
-        // Use batched write for performance
-        bool success = tas5805m_biquad::write_all_biquads_batched(
+        // Only send biquads that differ from the DSP's current contents
+        bool success = tas5805m_biquad::write_all_biquads_delta(
             bus, address, left_coeffs, right_coeffs
         );
 
         if (success) {
-            ESP_LOGI(TAG, "Successfully applied profile '%s' (%d filters)",
+            TAS5805M_PROFILE_LOGI("Successfully applied profile '%s' (%d filters)",
                      profile.name, profile.num_filters_used);
+            current_profile_shadow() = profile;
         }
 
+        // Migrate: next boot reads the compact record
+        migrate_legacy_slot(active_profile_index_, profile);
+
         return success;
     }
 
+    /**
+     * Apply the active profile once per boot, as early as the DAC allows
+     *
+     * Meant for an on_boot stage right after the tas5805m driver brings the
+     * chip up and before network and audio start, so the first sound after a
+     * reboot is already corrected. Returns immediately once it succeeded,
+     * so a later stage can call it again to retry a failed early attempt.
+     * A retry first closes the circuit breaker the failure may have opened,
+     * which would otherwise fail it fast for the cooldown.
+     *
+     * @param fs Sample rate the DSP runs at; designed slots are computed for it
+     */
+    bool apply_at_boot(esphome::i2c::I2CBus* bus, uint8_t address,
+                       float fs = tas5805m_biquad::REFERENCE_SAMPLE_RATE) {
+        if (boot_applied_) return true;
+
+        if (boot_attempts_ > 0) tas5805m_biquad::bus_health().close();
+        boot_attempts_++;
+
+        uint32_t start = esphome::millis();
+        if (!load_and_apply_active_profile(bus, address, fs)) {
+            TAS5805M_PROFILE_LOGW("Boot apply failed at %u ms", (unsigned)start);
+            return false;
+        }
+        boot_applied_ = true;
+
+        if (active_profile_index_ != -1) {
+            boot_corrected_ms_ = esphome::millis();
+            boot_apply_ms_ = boot_corrected_ms_ - start;
+            TAS5805M_PROFILE_LOGI("Correction active %u ms after boot (apply took %u ms)",
+                                  (unsigned)boot_corrected_ms_, (unsigned)boot_apply_ms_);
+        }
+        return true;
+    }
+
+    bool boot_applied() const { return boot_applied_; }
+
+    /**
+     * Uptime at which the boot apply finished (0 = not yet, or no active profile)
+     */
+    uint32_t boot_corrected_ms() const { return boot_corrected_ms_; }
+
+    /**
+     * Duration of the successful boot apply itself
+     */
+    uint32_t boot_apply_ms() const { return boot_apply_ms_; }
+
 private:
     esphome::ESPPreferenceObject active_pref_;
+    esphome::ESPPreferenceObject directory_pref_;
+    ProfileDirectory directory_;
     int8_t active_profile_index_;
+    uint32_t directory_saved_checksum_;          // Checksum of the directory as stored
+    int batch_depth_;                            // Open StorageBatch scopes
+    bool batch_dirty_;                           // Something was saved in the current batch
+    bool boot_applied_ = false;                  // apply_at_boot succeeded
+    uint8_t boot_attempts_ = 0;                  // apply_at_boot calls that tried the bus
+    uint32_t boot_corrected_ms_ = 0;
+    uint32_t boot_apply_ms_ = 0;
+
+    /**
+     * Groups the NVS writes of one operation into a single commit
+     *
+     * Nests like CoeffSession: the outermost batch calls sync() once on
+     * exit, and only if something was saved. Without it the writes would
+     * wait for the next periodic flash sync.
+     */
+    class StorageBatch {
+    public:
+        explicit StorageBatch(ProfileManager& manager) : manager_(manager) { manager_.batch_depth_++; }
+
+        ~StorageBatch() {
+            if (--manager_.batch_depth_ > 0 || !manager_.batch_dirty_) return;
+            manager_.batch_dirty_ = false;
+            if (!esphome::global_preferences->sync()) {
+                TAS5805M_PROFILE_LOGE("Failed to commit profile storage");
+            }
+        }
+
+        StorageBatch(const StorageBatch&) = delete;
+        StorageBatch& operator=(const StorageBatch&) = delete;
+
+    private:
+        ProfileManager& manager_;
+    };
+
+    /**
+     * Save a preference as part of the current batch
+     */
+    template<typename T>
+    bool write_pref(esphome::ESPPreferenceObject pref, const T& value) {
+        batch_dirty_ = true;
+        return pref.save(&value);
+    }
+
+    /**
+     * Copy a saved profile's metadata into its directory entry
+     */
+    void set_directory_entry(int slot, const CalibrationProfile& profile, uint8_t format) {
+        DirectoryEntry& entry = directory_.entries[slot];
+        memcpy(entry.name, profile.name, MAX_PROFILE_NAME_LEN);
+        entry.timestamp = profile.timestamp;
+        entry.checksum = profile.checksum;
+        entry.num_filters_used = profile.num_filters_used;
+        entry.in_use = 1;
+        entry.format = format;
+    }
+
+    /**
+     * Store the directory, unless it matches what is already in NVS
+     */
+    bool save_directory() {
+        directory_.update_checksum();
+        if (directory_.checksum == directory_saved_checksum_) return true;
+
+        if (!write_pref(directory_pref_, directory_)) {
+            TAS5805M_PROFILE_LOGE("Failed to save profile directory");
+            return false;
+        }
+        directory_saved_checksum_ = directory_.checksum;
+        return true;
+    }
+
+    /**
+     * Scan every slot once (first boot after upgrading, or corrupt directory)
+     *
+     * The record size identifies the format, so each slot is probed with
+     * the legacy sizes and then each compact size class.
+     */
+    void rebuild_directory() {
+        directory_ = ProfileDirectory();
+        for (int i = 0; i < static_cast<int>(MAX_PROFILES); i++) {
+            CalibrationProfile profile;
+            for (uint8_t format = FORMAT_LEGACY; format <= COMPACT_SIZE_CLASSES; format++) {
+                if (read_slot(i, format, profile)) {
+                    set_directory_entry(i, profile, format);
+                    break;
+                }
+            }
+        }
+        save_directory();
+    }
+
+    /**
+     * NVS entry for a profile slot, sized for record type T
+     */
+    template<typename T>
+    esphome::ESPPreferenceObject profile_pref(int slot) {
+        return esphome::global_preferences->make_preference<T>(fnv1_hash(get_profile_key(slot).c_str()));
+    }
+
+    /**
+     * Run fn on a compact record of the given directory format's size class
+     */
+    template<typename F>
+    static bool with_compact_record(uint8_t format, F&& fn) {
+        static_assert(COMPACT_SIZE_CLASSES == 6, "update the size class dispatch");
+        switch (format) {
+            case 1: { CompactProfileRecord<COMPACT_CAPACITIES[0]> record; return fn(record); }
+            case 2: { CompactProfileRecord<COMPACT_CAPACITIES[1]> record; return fn(record); }
+            case 3: { CompactProfileRecord<COMPACT_CAPACITIES[2]> record; return fn(record); }
+            case 4: { CompactProfileRecord<COMPACT_CAPACITIES[3]> record; return fn(record); }
+            case 5: { CompactProfileRecord<COMPACT_CAPACITIES[4]> record; return fn(record); }
+            case 6: { CompactProfileRecord<COMPACT_CAPACITIES[5]> record; return fn(record); }
+            default: return false;
+        }
+    }
+
+    /**
+     * Quantize, encode and store a profile in the compact format
+     *
+     * The stored profile is what loads back: coefficients round-trip through
+     * 9.23 and the checksum is taken after that.
+     */
+    bool store_compact(int slot, CalibrationProfile& profile) {
+        CompactProfileHeader header;
+        uint8_t payload[COMPACT_PAYLOAD_MAX];
+        size_t bytes = compact_encode(profile, header, payload);
+        uint8_t format = compact_format_for(bytes);
+
+        // Same content as stored: keep the record (and its timestamp) as is
+        const DirectoryEntry& entry = directory_.entries[slot];
+        if (entry.in_use && entry.format == format) {
+            uint32_t timestamp = header.timestamp;
+            header.timestamp = entry.timestamp;
+            compact_decode(header, payload, profile);
+            if (profile.checksum == entry.checksum) {
+                TAS5805M_PROFILE_LOGI("Profile '%s' in slot %d unchanged, not rewritten", profile.name, slot);
+                return true;
+            }
+            header.timestamp = timestamp;
+        }
+        compact_decode(header, payload, profile);
+
+        bool saved = with_compact_record(format, [&](auto& record) {
+            record.header = header;
+            memcpy(record.payload, payload, bytes);
+            record.checksum = record.calculate_checksum();
+            return write_pref(profile_pref<typename std::remove_reference<decltype(record)>::type>(slot), record);
+        });
+
+        if (!saved) {
+            TAS5805M_PROFILE_LOGE("Failed to save profile to slot %d", slot);
+            return false;
+        }
+
+        TAS5805M_PROFILE_LOGI("Saved profile '%s' to slot %d (%d filters, %d biquads in %d bytes%s)",
+                 profile.name, slot, profile.num_filters_used, header.stored, (int)bytes,
+                 (header.flags & COMPACT_FLAG_LINKED) ? ", linked" : "");
+
+        set_directory_entry(slot, profile, format);
+        return true;
+    }
+
+    /**
+     * Read and validate a compact record (header plus payload)
+     */
+    bool read_compact(int slot, uint8_t format, CompactProfileHeader& header, uint8_t* payload) {
+        return with_compact_record(format, [&](auto& record) {
+            auto pref = profile_pref<typename std::remove_reference<decltype(record)>::type>(slot);
+            if (!pref.load(&record) || !record.is_valid()) return false;
+
+            header = record.header;
+            memcpy(payload, record.payload, sizeof(record.payload));
+            return true;
+        });
+    }
+
+    /**
+     * Read a slot stored in the given format into a (validated) float profile
+     */
+    bool read_slot(int slot, uint8_t format, CalibrationProfile& profile) {
+        if (format != FORMAT_LEGACY) {
+            CompactProfileHeader header;
+            uint8_t payload[COMPACT_PAYLOAD_MAX];
+            if (!read_compact(slot, format, header, payload)) return false;
+
+            compact_decode(header, payload, profile);
+            return true;
+        }
+
+        LegacyCalibrationProfile legacy;
+        if (profile_pref<LegacyCalibrationProfile>(slot).load(&legacy)) {
+            if (!legacy.is_valid()) return false;
+            legacy.expand_to(profile);
+            return true;
+        }
+
+        // Stereo-linked profiles are stored with one channel
+        LinkedProfile linked;
+        if (!profile_pref<LinkedProfile>(slot).load(&linked) || !linked.is_valid()) return false;
+
+        linked.expand_to(profile);
+        return true;
+    }
+
+    /**
+     * Rewrite a profile saved by older firmware in the compact format
+     *
+     * Also shrinks the slot's old wire-image entry to one byte; the compact
+     * record carries the wire bytes itself.
+     */
+    void migrate_legacy_slot(int slot, CalibrationProfile profile) {
+        StorageBatch batch(*this);
+        if (!store_compact(slot, profile)) return;
+        save_directory();
+
+        char key[16];
+        snprintf(key, sizeof(key), "profile_img_%d", slot);
+        uint8_t tombstone = 0;
+        write_pref(esphome::global_preferences->make_preference<uint8_t>(fnv1_hash(key)), tombstone);
+
+        TAS5805M_PROFILE_LOGI("Migrated slot %d to the compact format", slot);
+    }
 
     /**
      * Generate NVS key for profile slot
@@ -412,12 +1285,10 @@ private:
      * Find profile slot by name
      */
     int find_profile_slot(const std::string& profile_name) {
-        for (int i = 0; i < MAX_PROFILES; i++) {
-            CalibrationProfile profile;
-            if (load_profile_by_index(i, profile)) {
-                if (strcmp(profile.name, profile_name.c_str()) == 0) {
-                    return i;
-                }
+        for (int i = 0; i < static_cast<int>(MAX_PROFILES); i++) {
+            const DirectoryEntry& entry = directory_.entries[i];
+            if (entry.in_use && strncmp(entry.name, profile_name.c_str(), MAX_PROFILE_NAME_LEN) == 0) {
+                return i;
             }
         }
         return -1;
@@ -441,15 +1312,108 @@ private:
 // =============================================================================
 
 /**
- * Capture current biquad state into a profile
- * (Requires reading back from TAS5805M or maintaining shadow state)
+ * Capture the biquads currently in DSP memory into a profile
+ *
+ * Reads all 30 biquads back from the chip (8 burst reads), so the result
+ * reflects what is actually playing, including filters written outside the
+ * profile shadow. Coefficients round-trip through 9.23, so they match the
+ * originals to within 2^-23.
+ *
+ * Touches the bus directly: call it from the main loop, like the writer,
+ * and verify through the writer first if commands may still be queued.
+ *
+ * @param profile Receives the coefficients, filter count and checksum (name left empty)
+ * @return false if any page read failed (profile left unchanged)
  */
-inline CalibrationProfile create_profile_from_current_state() {
-    CalibrationProfile profile;
-    // NOTE: This would need to read back from the chip or maintain shadow state
-    // For now, just return empty profile
-    ESP_LOGW(TAG, "create_profile_from_current_state not fully implemented");
-    return profile;
+inline bool create_profile_from_current_state(esphome::i2c::I2CBus* bus, uint8_t address,
+                                              CalibrationProfile& profile) {
+    tas5805m_biquad::BiquadCoeffs left[15];
+    tas5805m_biquad::BiquadCoeffs right[15];
+    if (!tas5805m_biquad::read_all_biquads(bus, address, left, right)) {
+        TAS5805M_PROFILE_LOGE("Failed to read biquads back from the DSP");
+        return false;
+    }
+
+    CalibrationProfile captured;
+    for (int i = 0; i < 15; i++) {
+        captured.left_channel[i] = BiquadCoefficients(left[i]);
+        captured.right_channel[i] = BiquadCoefficients(right[i]);
+    }
+    captured.count_active_filters();
+    captured.update_checksum();
+
+    TAS5805M_PROFILE_LOGI("Captured %d active filter(s) from DSP memory",
+                          captured.num_filters_used);
+    profile = captured;
+    return true;
+}
+
+/**
+ * Design for a biquad the optimizer produced
+ *
+ * Packing moves filters between slots and merging replaces two bands with
+ * a fitted PEQ, so designs are matched by coefficients: a filter kept as
+ * is takes its original design, and a merged band is read back as a
+ * peaking EQ and redesigned from those parameters (a float-rounding
+ * change) so it can follow the sample rate. Anything else becomes RAW.
+ */
+inline tas5805m_biquad::FilterDesign design_after_optimize(const BiquadCoefficients (&coeffs)[15],
+                                                           const tas5805m_biquad::FilterDesign (&designs)[15],
+                                                           tas5805m_biquad::BiquadCoeffs& optimized,
+                                                           float fs) {
+    const BiquadCoefficients kept(optimized);
+    for (int i = 0; i < 15; i++) {
+        if (memcmp(&coeffs[i], &kept, sizeof(kept)) == 0) return designs[i];
+    }
+
+    tas5805m_cascade::PeqParams peq;
+    if (fs == tas5805m_biquad::REFERENCE_SAMPLE_RATE && tas5805m_cascade::peq_params(optimized, fs, peq)) {
+        tas5805m_biquad::FilterDesign design(tas5805m_biquad::FilterType::PEAKING, peq.frequency, peq.gain_db, peq.q);
+        if (tas5805m_biquad::calc_filter(design, fs, optimized)) return design;
+    }
+    return tas5805m_biquad::FilterDesign();
+}
+
+/**
+ * Run the cascade optimizer over both channels of a profile
+ *
+ * Drops negligible bands, merges overlapping PEQs and packs each channel's
+ * filters into its lowest slots, so a profile apply touches fewer pages and
+ * the freed slots can take a crossover. Filter indices change, so optimize
+ * before saving rather than between per-slot edits.
+ *
+ * @return number of biquad slots freed (summed over both channels)
+ */
+inline int optimize_profile(CalibrationProfile& profile,
+                            const tas5805m_cascade::CascadeOptions& options = tas5805m_cascade::CascadeOptions()) {
+    tas5805m_biquad::BiquadCoeffs left[15];
+    tas5805m_biquad::BiquadCoeffs right[15];
+    for (int i = 0; i < 15; i++) {
+        left[i] = profile.left_channel[i].to_coeffs();
+        right[i] = profile.right_channel[i].to_coeffs();
+    }
+
+    tas5805m_cascade::CascadeReport left_report, right_report;
+    tas5805m_cascade::optimize_channel(left, options, &left_report);
+    tas5805m_cascade::optimize_channel(right, options, &right_report);
+
+    CalibrationProfile original = profile;
+    for (int i = 0; i < 15; i++) {
+        profile.left_design[i] = design_after_optimize(original.left_channel, original.left_design,
+                                                       left[i], options.fs);
+        profile.right_design[i] = design_after_optimize(original.right_channel, original.right_design,
+                                                        right[i], options.fs);
+        profile.left_channel[i] = BiquadCoefficients(left[i]);
+        profile.right_channel[i] = BiquadCoefficients(right[i]);
+    }
+    profile.count_active_filters();
+    profile.update_checksum();
+
+    int freed = (left_report.before - left_report.after) + (right_report.before - right_report.after);
+    TAS5805M_PROFILE_LOGI("Optimized profile: L %d -> %d, R %d -> %d filters (max error %.2f / %.2f dB)",
+                          left_report.before, left_report.after, right_report.before, right_report.after,
+                          left_report.max_error_db, right_report.max_error_db);
+    return freed;
 }
 
 /**
@@ -459,7 +1423,7 @@ inline void add_filter_to_profile(CalibrationProfile& profile,
                                   int channel, int index,
                                   float b0, float b1, float b2, float a1, float a2) {
     if (index < 0 || index >= 15) {
-        ESP_LOGE(TAG, "Invalid biquad index: %d", index);
+        TAS5805M_PROFILE_LOGE("Invalid biquad index: %d", index);
         return;
     }
 
@@ -467,11 +1431,96 @@ inline void add_filter_to_profile(CalibrationProfile& profile,
 
     if (channel == 0 || channel == 2) {  // Left or both
         profile.left_channel[index] = coeffs;
+        profile.left_design[index] = tas5805m_biquad::FilterDesign();
     }
 
     if (channel == 1 || channel == 2) {  // Right or both
         profile.right_channel[index] = coeffs;
+        profile.right_design[index] = tas5805m_biquad::FilterDesign();
+    }
+}
+
+/**
+ * Record a designed filter in a profile
+ *
+ * Stores the design and its reference-rate coefficients, so the slot can
+ * be regenerated when the sample rate changes.
+ *
+ * @return false if the design has no coefficients at the reference rate
+ */
+inline bool add_filter_to_profile(CalibrationProfile& profile, int channel, int index,
+                                  const tas5805m_biquad::FilterDesign& design) {
+    if (index < 0 || index >= 15) {
+        TAS5805M_PROFILE_LOGE("Invalid biquad index: %d", index);
+        return false;
     }
+
+    tas5805m_biquad::BiquadCoeffs coeffs;
+    if (!tas5805m_biquad::calc_filter(design, tas5805m_biquad::REFERENCE_SAMPLE_RATE, coeffs)) {
+        TAS5805M_PROFILE_LOGE("Filter design has no coefficients at %.0f Hz",
+                              tas5805m_biquad::REFERENCE_SAMPLE_RATE);
+        return false;
+    }
+
+    add_filter_to_profile(profile, channel, index, coeffs.b0, coeffs.b1, coeffs.b2, coeffs.a1, coeffs.a2);
+    if (channel == 0 || channel == 2) profile.left_design[index] = design;
+    if (channel == 1 || channel == 2) profile.right_design[index] = design;
+    return true;
+}
+
+// Values per slot in an uploaded filter array:
+// type (FilterType, 0 = bypass), frequency, gain_db, q (slope for the shelves)
+constexpr size_t UPLOAD_FIELDS_PER_FILTER = 4;
+
+/**
+ * Build a profile from a bulk upload (upload_profile service)
+ *
+ * Each channel is a flat array of up to 15 filters; slots past its end are
+ * bypassed. An empty right array makes the profile stereo-linked. Every
+ * entry is validated (for fs as well as the reference rate) before
+ * anything is written to the profile.
+ *
+ * @return false, leaving the profile untouched, if any entry is invalid
+ */
+inline bool profile_from_upload(const std::vector<float>& left, const std::vector<float>& right,
+                                float fs, CalibrationProfile& profile) {
+    const bool linked = right.empty();
+    const std::vector<float>* channels[2] = {&left, &right};
+
+    CalibrationProfile uploaded;
+    for (int ch = 0; ch < (linked ? 1 : 2); ch++) {
+        const std::vector<float>& values = *channels[ch];
+        if (values.size() % UPLOAD_FIELDS_PER_FILTER != 0 ||
+            values.size() > 15 * UPLOAD_FIELDS_PER_FILTER) {
+            TAS5805M_PROFILE_LOGE("Invalid upload: %u values for %s (need up to 15 x %u)",
+                                  (unsigned)values.size(), ch == 0 ? "left" : "right",
+                                  (unsigned)UPLOAD_FIELDS_PER_FILTER);
+            return false;
+        }
+
+        for (size_t slot = 0; slot < values.size() / UPLOAD_FIELDS_PER_FILTER; slot++) {
+            const float* v = &values[slot * UPLOAD_FIELDS_PER_FILTER];
+            if (v[0] == 0.0f) continue;  // Bypass
+
+            const float max_type = static_cast<float>(tas5805m_biquad::FilterType::NOTCH);
+            int type = (v[0] > 0.0f && v[0] <= max_type) ? static_cast<int>(v[0]) : 0;
+            if (type == 0 || static_cast<float>(type) != v[0]) {
+                TAS5805M_PROFILE_LOGE("Invalid upload: filter type %.1f in slot %u", v[0], (unsigned)slot);
+                return false;
+            }
+
+            tas5805m_biquad::FilterDesign design(static_cast<tas5805m_biquad::FilterType>(type), v[1], v[2], v[3]);
+            if (!tas5805m_biquad::validate_design(design, fs) ||
+                !add_filter_to_profile(uploaded, linked ? 2 : ch, static_cast<int>(slot), design)) {
+                TAS5805M_PROFILE_LOGE("Invalid upload: %s slot %u", ch == 0 ? "left" : "right", (unsigned)slot);
+                return false;
+            }
+        }
+    }
+
+    uploaded.count_active_filters();
+    profile = uploaded;
+    return true;
 }
 
 // =============================================================================
@@ -486,8 +1535,16 @@ static CalibrationProfile g_current_profile_shadow;
 // Profile manager instance
 static ProfileManager g_profile_manager;
 
+// Sample rate the I2S bus feeds the DSP at (designed slots are computed for it)
+static float g_dsp_sample_rate = tas5805m_biquad::REFERENCE_SAMPLE_RATE;
+
+// Wire images of the shadow at recently used rates
+static RateImageCache g_rate_image_cache;
+
 // Accessor functions for ESPHome lambdas
 inline CalibrationProfile& current_profile_shadow() { return g_current_profile_shadow; }
 inline ProfileManager& profile_manager() { return g_profile_manager; }
+inline float& dsp_sample_rate() { return g_dsp_sample_rate; }
+inline RateImageCache& rate_image_cache() { return g_rate_image_cache; }
 
 }  // namespace tas5805m_profile
@@ -9,6 +9,7 @@
  */
 
 #include <cstdio>
+#include <cstddef>
 #include <cstdint>
 #include <cmath>
 #include <cstring>
@@ -21,10 +22,10 @@
 // =============================================================================
 
 // Mock ESP logging macros
-#define ESP_LOGE(tag, fmt, ...) ((void)0)
-#define ESP_LOGW(tag, fmt, ...) ((void)0)
-#define ESP_LOGI(tag, fmt, ...) ((void)0)
-#define ESP_LOGD(tag, fmt, ...) ((void)0)
+#define ESP_LOGE(tag, fmt, ...) do { if (0) printf(fmt, ##__VA_ARGS__); } while (0)
+#define ESP_LOGW(tag, fmt, ...) do { if (0) printf(fmt, ##__VA_ARGS__); } while (0)
+#define ESP_LOGI(tag, fmt, ...) do { if (0) printf(fmt, ##__VA_ARGS__); } while (0)
+#define ESP_LOGD(tag, fmt, ...) do { if (0) printf(fmt, ##__VA_ARGS__); } while (0)
 
 // Mock delay function
 inline void delay(uint32_t ms) { (void)ms; }
@@ -104,198 +105,15 @@ static int tests_failed = 0;
 // INCLUDE THE CODE UNDER TEST (after mocks are defined)
 // =============================================================================
 
-// We need to extract just the testable functions without the I2C-dependent ones
-// For this test, we'll copy the pure functions inline
+// Dependency-free headers are included directly, so the tested math is the
+// shipped math
+#include "tas5805m_dsp_math.h"
+#include "tas5805m_cascade.h"
+#include "tas5805m_crc32.h"
+#include "tas5805m_loudness.h"
 
-namespace tas5805m_biquad {
-
-// Validation functions
-inline bool validate_channel(int channel) {
-    if (channel < 0 || channel > 2) {
-        return false;
-    }
-    return true;
-}
-
-inline bool validate_index(int index) {
-    if (index < 0 || index >= 15) {
-        return false;
-    }
-    return true;
-}
-
-inline bool validate_frequency(float frequency, float min_freq = 10.0f, float max_freq = 24000.0f) {
-    if (!std::isfinite(frequency) || frequency < min_freq || frequency > max_freq) {
-        return false;
-    }
-    return true;
-}
-
-inline bool validate_gain(float gain_db, float min_gain = -20.0f, float max_gain = 20.0f) {
-    if (!std::isfinite(gain_db) || gain_db < min_gain || gain_db > max_gain) {
-        return false;
-    }
-    return true;
-}
-
-inline bool validate_q(float q, float min_q = 0.1f, float max_q = 20.0f) {
-    if (!std::isfinite(q) || q < min_q || q > max_q) {
-        return false;
-    }
-    return true;
-}
-
-inline bool validate_slope(float slope, float min_slope = 0.1f, float max_slope = 5.0f) {
-    if (!std::isfinite(slope) || slope < min_slope || slope > max_slope) {
-        return false;
-    }
-    return true;
-}
-
-inline bool validate_coefficients(float b0, float b1, float b2, float a1, float a2) {
-    if (!std::isfinite(b0) || !std::isfinite(b1) || !std::isfinite(b2) ||
-        !std::isfinite(a1) || !std::isfinite(a2)) {
-        return false;
-    }
-    return true;
-}
-
-// Conversion functions
-inline int32_t float_to_9_23(float value) {
-    if (!std::isfinite(value)) {
-        return 0;
-    }
-    if (value > 255.999999f) value = 255.999999f;
-    if (value < -256.0f) value = -256.0f;
-    return static_cast<int32_t>(value * (1 << 23));
-}
-
-inline void pack_be32(int32_t value, uint8_t* buffer) {
-    buffer[0] = (value >> 24) & 0xFF;
-    buffer[1] = (value >> 16) & 0xFF;
-    buffer[2] = (value >> 8) & 0xFF;
-    buffer[3] = value & 0xFF;
-}
-
-// Filter coefficient calculators (pure math, returning coefficients)
-struct FilterCoeffs {
-    float b0, b1, b2, a1, a2;
-};
-
-inline FilterCoeffs calc_parametric_eq(float frequency, float gain_db, float q, float fs = 48000.0f) {
-    const float A = std::pow(10.0f, gain_db / 40.0f);
-    const float omega = 2.0f * M_PI * frequency / fs;
-    const float sin_omega = std::sin(omega);
-    const float cos_omega = std::cos(omega);
-    const float alpha = sin_omega / (2.0f * q);
-
-    float b0 = 1.0f + alpha * A;
-    float b1 = -2.0f * cos_omega;
-    float b2 = 1.0f - alpha * A;
-    float a0 = 1.0f + alpha / A;
-    float a1 = -2.0f * cos_omega;
-    float a2 = 1.0f - alpha / A;
-
-    b0 /= a0; b1 /= a0; b2 /= a0; a1 /= a0; a2 /= a0;
-
-    return {b0, b1, b2, a1, a2};
-}
-
-inline FilterCoeffs calc_low_shelf(float frequency, float gain_db, float slope = 1.0f, float fs = 48000.0f) {
-    const float A = std::pow(10.0f, gain_db / 40.0f);
-    const float omega = 2.0f * M_PI * frequency / fs;
-    const float sin_omega = std::sin(omega);
-    const float cos_omega = std::cos(omega);
-    const float alpha = sin_omega / 2.0f * std::sqrt((A + 1.0f/A) * (1.0f/slope - 1.0f) + 2.0f);
-    const float two_sqrt_A_alpha = 2.0f * std::sqrt(A) * alpha;
-
-    float b0 = A * ((A + 1.0f) - (A - 1.0f) * cos_omega + two_sqrt_A_alpha);
-    float b1 = 2.0f * A * ((A - 1.0f) - (A + 1.0f) * cos_omega);
-    float b2 = A * ((A + 1.0f) - (A - 1.0f) * cos_omega - two_sqrt_A_alpha);
-    float a0 = (A + 1.0f) + (A - 1.0f) * cos_omega + two_sqrt_A_alpha;
-    float a1 = -2.0f * ((A - 1.0f) + (A + 1.0f) * cos_omega);
-    float a2 = (A + 1.0f) + (A - 1.0f) * cos_omega - two_sqrt_A_alpha;
-
-    b0 /= a0; b1 /= a0; b2 /= a0; a1 /= a0; a2 /= a0;
-
-    return {b0, b1, b2, a1, a2};
-}
-
-inline FilterCoeffs calc_high_shelf(float frequency, float gain_db, float slope = 1.0f, float fs = 48000.0f) {
-    const float A = std::pow(10.0f, gain_db / 40.0f);
-    const float omega = 2.0f * M_PI * frequency / fs;
-    const float sin_omega = std::sin(omega);
-    const float cos_omega = std::cos(omega);
-    const float alpha = sin_omega / 2.0f * std::sqrt((A + 1.0f/A) * (1.0f/slope - 1.0f) + 2.0f);
-    const float two_sqrt_A_alpha = 2.0f * std::sqrt(A) * alpha;
-
-    float b0 = A * ((A + 1.0f) + (A - 1.0f) * cos_omega + two_sqrt_A_alpha);
-    float b1 = -2.0f * A * ((A - 1.0f) + (A + 1.0f) * cos_omega);
-    float b2 = A * ((A + 1.0f) + (A - 1.0f) * cos_omega - two_sqrt_A_alpha);
-    float a0 = (A + 1.0f) - (A - 1.0f) * cos_omega + two_sqrt_A_alpha;
-    float a1 = 2.0f * ((A - 1.0f) - (A + 1.0f) * cos_omega);
-    float a2 = (A + 1.0f) - (A - 1.0f) * cos_omega - two_sqrt_A_alpha;
-
-    b0 /= a0; b1 /= a0; b2 /= a0; a1 /= a0; a2 /= a0;
-
-    return {b0, b1, b2, a1, a2};
-}
-
-inline FilterCoeffs calc_highpass(float frequency, float q, float fs = 48000.0f) {
-    const float omega = 2.0f * M_PI * frequency / fs;
-    const float sin_omega = std::sin(omega);
-    const float cos_omega = std::cos(omega);
-    const float alpha = sin_omega / (2.0f * q);
-
-    float b0 = (1.0f + cos_omega) / 2.0f;
-    float b1 = -(1.0f + cos_omega);
-    float b2 = (1.0f + cos_omega) / 2.0f;
-    float a0 = 1.0f + alpha;
-    float a1 = -2.0f * cos_omega;
-    float a2 = 1.0f - alpha;
-
-    b0 /= a0; b1 /= a0; b2 /= a0; a1 /= a0; a2 /= a0;
-
-    return {b0, b1, b2, a1, a2};
-}
-
-inline FilterCoeffs calc_lowpass(float frequency, float q, float fs = 48000.0f) {
-    const float omega = 2.0f * M_PI * frequency / fs;
-    const float sin_omega = std::sin(omega);
-    const float cos_omega = std::cos(omega);
-    const float alpha = sin_omega / (2.0f * q);
-
-    float b0 = (1.0f - cos_omega) / 2.0f;
-    float b1 = 1.0f - cos_omega;
-    float b2 = (1.0f - cos_omega) / 2.0f;
-    float a0 = 1.0f + alpha;
-    float a1 = -2.0f * cos_omega;
-    float a2 = 1.0f - alpha;
-
-    b0 /= a0; b1 /= a0; b2 /= a0; a1 /= a0; a2 /= a0;
-
-    return {b0, b1, b2, a1, a2};
-}
-
-inline FilterCoeffs calc_notch(float frequency, float q, float fs = 48000.0f) {
-    const float omega = 2.0f * M_PI * frequency / fs;
-    const float sin_omega = std::sin(omega);
-    const float cos_omega = std::cos(omega);
-    const float alpha = sin_omega / (2.0f * q);
-
-    float b0 = 1.0f;
-    float b1 = -2.0f * cos_omega;
-    float b2 = 1.0f;
-    float a0 = 1.0f + alpha;
-    float a1 = -2.0f * cos_omega;
-    float a2 = 1.0f - alpha;
-
-    b0 /= a0; b1 /= a0; b2 /= a0; a1 /= a0; a2 /= a0;
-
-    return {b0, b1, b2, a1, a2};
-}
-
-}  // namespace tas5805m_biquad
+// The profile manager needs ESPHome preferences; its pure structures are
+// copied here
 
 // Profile structures
 namespace tas5805m_profile {
@@ -568,6 +386,59 @@ TEST(pack_be32_unity_9_23) {
     ASSERT_EQ(buffer[3], 0x00);
 }
 
+TEST(pack_coeffs_inverts_feedback) {
+    // Wire layout: b0 b1 b2 -a1 -a2, each 9.23 big-endian
+    uint8_t wire[tas5805m_biquad::BIQUAD_WIRE_BYTES];
+    tas5805m_biquad::pack_coeffs(1.0f, 0.0f, 0.0f, 0.5f, -0.25f, wire);
+    ASSERT_EQ(wire[1], 0x80);                          // b0 = 0x00800000
+    ASSERT_EQ(wire[12], 0xFF); ASSERT_EQ(wire[13], 0xC0);  // -a1 = -0.5
+    ASSERT_EQ(wire[16], 0x00); ASSERT_EQ(wire[17], 0x20);  // -a2 = +0.25
+}
+
+TEST(unpack_biquad_round_trips_pack) {
+    // Readback decodes 9.23 and undoes the a1/a2 inversion
+    tas5805m_biquad::BiquadCoeffs c = tas5805m_biquad::calc_parametric_eq(250.0f, -4.0f, 3.0f);
+    uint8_t wire[tas5805m_biquad::BIQUAD_WIRE_BYTES];
+    tas5805m_biquad::pack_biquad(c, wire);
+
+    tas5805m_biquad::BiquadCoeffs back = tas5805m_biquad::unpack_biquad(wire);
+    ASSERT_NEAR(back.b0, c.b0, 1e-6f);
+    ASSERT_NEAR(back.b1, c.b1, 1e-6f);
+    ASSERT_NEAR(back.b2, c.b2, 1e-6f);
+    ASSERT_NEAR(back.a1, c.a1, 1e-6f);
+    ASSERT_NEAR(back.a2, c.a2, 1e-6f);
+    ASSERT_EQ(tas5805m_biquad::unpack_be32(&wire[12]), tas5805m_biquad::float_to_9_23(-c.a1));
+}
+
+TEST(constexpr_designer_matches_runtime) {
+    // Compile-time presets must land within 1 LSB of the float designers
+    constexpr tas5805m_biquad::BiquadWire peq = tas5805m_biquad::design_parametric_eq(1000.0, -6.0, 2.0);
+    uint8_t runtime[tas5805m_biquad::BIQUAD_WIRE_BYTES];
+    tas5805m_biquad::pack_biquad(tas5805m_biquad::calc_parametric_eq(1000.0f, -6.0f, 2.0f), runtime);
+
+    for (int i = 0; i < 5; i++) {
+        const uint8_t* a = &peq.bytes[i * 4];
+        const uint8_t* b = &runtime[i * 4];
+        int32_t wa = (int32_t)((uint32_t)a[0] << 24 | a[1] << 16 | a[2] << 8 | a[3]);
+        int32_t wb = (int32_t)((uint32_t)b[0] << 24 | b[1] << 16 | b[2] << 8 | b[3]);
+        ASSERT_TRUE(std::abs(wa - wb) <= 1);
+    }
+}
+
+TEST(trig_cache_independent_of_history) {
+    // A graphic EQ centre must design the same bytes whether it hits its
+    // seeded slot or is recomputed after another frequency evicted it
+    uint8_t seeded[tas5805m_biquad::BIQUAD_WIRE_BYTES];
+    tas5805m_biquad::pack_biquad(tas5805m_biquad::calc_parametric_eq(8000.0f, 6.0f, 2.0f), seeded);
+
+    for (float f = 8001.0f; f <= 8100.0f; f += 1.0f) {
+        tas5805m_biquad::calc_parametric_eq(f, 6.0f, 2.0f);
+    }
+    uint8_t recomputed[tas5805m_biquad::BIQUAD_WIRE_BYTES];
+    tas5805m_biquad::pack_biquad(tas5805m_biquad::calc_parametric_eq(8000.0f, 6.0f, 2.0f), recomputed);
+    ASSERT_EQ(memcmp(seeded, recomputed, sizeof(seeded)), 0);
+}
+
 // =============================================================================
 // TESTS: FILTER COEFFICIENT CALCULATORS
 // =============================================================================
@@ -788,6 +659,319 @@ TEST(fnv1_hash_profile_keys) {
     ASSERT_TRUE(h3 != h4);
 }
 
+// =============================================================================
+// TESTS: CRC32
+// =============================================================================
+
+TEST(crc32_known_vector) {
+    const char* check = "123456789";
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(check);
+    ASSERT_EQ(tas5805m_crc::crc32_bitwise(data, 9), 0xCBF43926u);
+    ASSERT_EQ(tas5805m_crc::crc32_slice8(data, 9), 0xCBF43926u);
+    ASSERT_EQ(tas5805m_crc::crc32_slice8(data, 0), 0u);
+}
+
+TEST(crc32_slice8_matches_bitwise) {
+    // Every length and start offset up to a bit over a full profile, so the
+    // 8-byte loop, the tail loop and unaligned starts are all exercised
+    uint8_t buffer[700];
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        seed = seed * 1103515245u + 12345u;
+        buffer[i] = static_cast<uint8_t>(seed >> 16);
+    }
+
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t len = 0; len + offset <= sizeof(buffer); len += 13) {
+            ASSERT_EQ(tas5805m_crc::crc32_slice8(buffer + offset, len),
+                      tas5805m_crc::crc32_bitwise(buffer + offset, len));
+        }
+    }
+}
+
+TEST(crc32_compatible_with_saved_profiles) {
+    // Profiles already in NVS were checksummed with the bitwise loop
+    tas5805m_profile::CalibrationProfile p;
+    strncpy(p.name, "Living Room", tas5805m_profile::MAX_PROFILE_NAME_LEN - 1);
+    p.left_channel[3] = tas5805m_profile::BiquadCoefficients(1.2f, -1.8f, 0.6f, -1.7f, 0.85f);
+    p.update_checksum();
+
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(&p);
+    size_t len = offsetof(tas5805m_profile::CalibrationProfile, checksum);
+    ASSERT_EQ(tas5805m_crc::crc32(data, len), p.checksum);
+}
+
+// =============================================================================
+// TESTS: CASCADE OPTIMIZER
+// =============================================================================
+
+using tas5805m_biquad::BiquadCoeffs;
+
+// Worst-case dB difference between two cascades, evaluated independently of
+// the optimizer (double precision, from the coefficients, on a denser grid)
+static double biquad_db(const BiquadCoeffs& c, double w) {
+    double cr = std::cos(w), ci = -std::sin(w), c2r = std::cos(2 * w), c2i = -std::sin(2 * w);
+    double nr = c.b0 + c.b1 * cr + c.b2 * c2r, ni = c.b1 * ci + c.b2 * c2i;
+    double dr = 1.0 + c.a1 * cr + c.a2 * c2r, di = c.a1 * ci + c.a2 * c2i;
+    return 10.0 * std::log10((nr * nr + ni * ni) / (dr * dr + di * di));
+}
+
+static float cascade_difference_db(const BiquadCoeffs* a, const BiquadCoeffs* b) {
+    double worst = 0.0;
+    for (int i = 0; i < 600; i++) {
+        double w = 2.0 * M_PI * 20.0 * std::pow(1000.0, i / 599.0) / 48000.0;
+        double diff = 0.0;
+        for (int k = 0; k < 15; k++) diff += biquad_db(a[k], w) - biquad_db(b[k], w);
+        if (std::fabs(diff) > worst) worst = std::fabs(diff);
+    }
+    return static_cast<float>(worst);
+}
+
+TEST(cascade_peq_params_recovers_design) {
+    tas5805m_cascade::PeqParams p;
+    ASSERT_TRUE(tas5805m_cascade::peq_params(
+        tas5805m_biquad::calc_parametric_eq(250.0f, -4.5f, 3.0f), 48000.0f, p));
+    ASSERT_NEAR(p.frequency, 250.0f, 0.5f);
+    ASSERT_NEAR(p.gain_db, -4.5f, 0.01f);
+    ASSERT_NEAR(p.q, 3.0f, 0.01f);
+
+    // Other filter types are left alone
+    ASSERT_FALSE(tas5805m_cascade::peq_params(
+        tas5805m_biquad::calc_highpass(30.0f, 0.707f), 48000.0f, p));
+    ASSERT_FALSE(tas5805m_cascade::peq_params(
+        tas5805m_biquad::calc_low_shelf(100.0f, 3.0f), 48000.0f, p));
+    ASSERT_FALSE(tas5805m_cascade::peq_params(BiquadCoeffs(), 48000.0f, p));
+}
+
+TEST(cascade_drops_inaudible_bands) {
+    BiquadCoeffs ch[15];
+    ch[2] = tas5805m_biquad::calc_parametric_eq(80.0f, -6.0f, 4.0f);
+    ch[5] = tas5805m_biquad::calc_parametric_eq(2000.0f, 0.1f, 2.0f);
+    ch[9] = tas5805m_biquad::calc_parametric_eq(6000.0f, -0.15f, 1.0f);
+    BiquadCoeffs original[15];
+    memcpy(original, ch, sizeof(ch));
+
+    tas5805m_cascade::CascadeReport report;
+    ASSERT_EQ(tas5805m_cascade::optimize_channel(ch, tas5805m_cascade::CascadeOptions(), &report), 1);
+    ASSERT_EQ(report.before, 3);
+    ASSERT_EQ(report.dropped, 2);
+    ASSERT_TRUE(cascade_difference_db(ch, original) <= 0.5f);
+}
+
+TEST(cascade_merges_overlapping_peqs) {
+    BiquadCoeffs ch[15];
+    ch[0] = tas5805m_biquad::calc_highpass(25.0f, 0.707f);
+    ch[3] = tas5805m_biquad::calc_parametric_eq(100.0f, -3.0f, 2.0f);
+    ch[4] = tas5805m_biquad::calc_parametric_eq(106.0f, -3.0f, 2.0f);
+    ch[8] = tas5805m_biquad::calc_parametric_eq(3000.0f, 2.0f, 1.5f);
+    BiquadCoeffs original[15];
+    memcpy(original, ch, sizeof(ch));
+
+    tas5805m_cascade::CascadeReport report;
+    tas5805m_cascade::optimize_channel(ch, tas5805m_cascade::CascadeOptions(), &report);
+    ASSERT_EQ(report.merged, 1);
+    ASSERT_EQ(report.after, 3);
+    ASSERT_TRUE(report.max_error_db <= 0.5f);
+    ASSERT_TRUE(cascade_difference_db(ch, original) <= 0.6f);
+
+    // Packed: high-pass first, then the merged band and the 3 kHz band
+    ASSERT_NEAR(ch[0].b0, original[0].b0, 1e-6f);
+    for (int k = 3; k < 15; k++) ASSERT_TRUE(ch[k].is_bypass());
+}
+
+TEST(cascade_keeps_distant_or_strong_bands) {
+    BiquadCoeffs ch[15];
+    ch[1] = tas5805m_biquad::calc_parametric_eq(60.0f, -8.0f, 6.0f);
+    ch[6] = tas5805m_biquad::calc_parametric_eq(4000.0f, -8.0f, 6.0f);
+    ch[7] = tas5805m_biquad::calc_notch(1000.0f, 8.0f);
+
+    tas5805m_cascade::CascadeOptions options;
+    options.pack = false;
+    tas5805m_cascade::CascadeReport report;
+    tas5805m_cascade::optimize_channel(ch, options, &report);
+    ASSERT_EQ(report.after, 3);
+    ASSERT_EQ(report.merged, 0);
+    ASSERT_FALSE(ch[1].is_bypass());
+    ASSERT_FALSE(ch[7].is_bypass());
+}
+
+TEST(cascade_respects_error_budget) {
+    // Many small, overlapping bands, as a measurement fit tends to produce
+    BiquadCoeffs ch[15];
+    for (int k = 0; k < 15; k++) {
+        float f = 40.0f * std::pow(1.35f, (float)k);
+        ch[k] = tas5805m_biquad::calc_parametric_eq(f, (k % 3 == 0) ? -2.0f : -0.8f, 2.5f);
+    }
+    BiquadCoeffs original[15];
+    memcpy(original, ch, sizeof(ch));
+
+    tas5805m_cascade::CascadeOptions options;
+    options.max_error_db = 0.3f;
+    tas5805m_cascade::CascadeReport report;
+    tas5805m_cascade::optimize_channel(ch, options, &report);
+    ASSERT_TRUE(report.after < 15);
+    ASSERT_TRUE(report.max_error_db <= 0.3f);
+    ASSERT_TRUE(cascade_difference_db(ch, original) <= 0.4f);
+}
+
+// =============================================================================
+// TESTS: LOUDNESS CACHE
+// =============================================================================
+
+// Records pin_biquad / unpin_biquad calls instead of writing
+struct FakeWriter {
+    int pins = 0;
+    int channel = -1;
+    uint16_t pinned = 0;
+    uint8_t slots[15][tas5805m_biquad::BIQUAD_WIRE_BYTES] = {};
+
+    uint32_t pin_biquad(int ch, int index, const uint8_t* wire) {
+        pins++;
+        channel = ch;
+        pinned |= 1u << index;
+        memcpy(slots[index], wire, tas5805m_biquad::BIQUAD_WIRE_BYTES);
+        return static_cast<uint32_t>(pins);
+    }
+
+    void unpin_biquad(int, int index) { pinned &= ~(1u << index); }
+};
+
+// Built and placed with the whole profile free (shelves in 13 and 14)
+static void build_loudness(tas5805m_loudness::LoudnessCache& cache, FakeWriter& writer, float fs) {
+    uint16_t released;
+    cache.build(tas5805m_loudness::LoudnessSettings(), fs);
+    cache.fit(writer, 0, released);
+}
+
+TEST(loudness_breakpoints_follow_volume) {
+    tas5805m_loudness::LoudnessCache cache;
+    tas5805m_loudness::LoudnessSettings settings;
+    ASSERT_TRUE(cache.build(settings, 48000.0f));
+
+    ASSERT_EQ(cache.breakpoint_for(1.0f), 0);
+    ASSERT_EQ(cache.breakpoint_for(settings.reference_volume), 0);
+    ASSERT_EQ(cache.breakpoint_for(0.0f), settings.breakpoints - 1);
+    ASSERT_EQ(cache.breakpoint_for(settings.reference_volume / 2.0f), (settings.breakpoints - 1) / 2);
+    ASSERT_EQ(cache.breakpoint_for(std::numeric_limits<float>::quiet_NaN()), 0);
+
+    // Breakpoint 0 is flat; a shelf at 0 dB packs to bypass
+    uint8_t bypass[tas5805m_biquad::BIQUAD_WIRE_BYTES];
+    tas5805m_biquad::pack_biquad(BiquadCoeffs(), bypass);
+    ASSERT_TRUE(memcmp(cache.wire(0, 0), bypass, sizeof(bypass)) == 0);
+    ASSERT_TRUE(memcmp(cache.wire(0, 1), bypass, sizeof(bypass)) == 0);
+}
+
+TEST(loudness_writes_only_on_breakpoint_change) {
+    tas5805m_loudness::LoudnessCache cache;
+    tas5805m_loudness::LoudnessSettings settings;
+    FakeWriter writer;
+    build_loudness(cache, writer, 48000.0f);
+    ASSERT_EQ(cache.bass_slot(), 13);
+    ASSERT_EQ(cache.treble_slot(), 14);
+
+    // Zero volume: full boost, both shelves on both channels
+    ASSERT_TRUE(cache.follow(writer, 0.0f) != 0);
+    ASSERT_EQ(writer.pins, 2);
+    ASSERT_EQ(writer.channel, 2);
+    uint8_t expected[tas5805m_biquad::BIQUAD_WIRE_BYTES];
+    tas5805m_biquad::pack_biquad(
+        tas5805m_biquad::calc_low_shelf(settings.bass_frequency, settings.bass_max_db,
+                                        settings.slope, 48000.0f), expected);
+    ASSERT_TRUE(memcmp(writer.slots[cache.bass_slot()], expected, sizeof(expected)) == 0);
+    tas5805m_biquad::pack_biquad(
+        tas5805m_biquad::calc_high_shelf(settings.treble_frequency, settings.treble_max_db,
+                                         settings.slope, 48000.0f), expected);
+    ASSERT_TRUE(memcmp(writer.slots[cache.treble_slot()], expected, sizeof(expected)) == 0);
+
+    // Steps that stay on the breakpoint cost nothing
+    ASSERT_EQ(cache.follow(writer, 0.01f), 0u);
+    ASSERT_EQ(cache.follow(writer, 0.0f), 0u);
+    ASSERT_EQ(writer.pins, 2);
+
+    // A 0.05 step moves one breakpoint
+    ASSERT_TRUE(cache.follow(writer, 0.05f) != 0);
+    ASSERT_EQ(writer.pins, 4);
+    ASSERT_EQ(cache.current(), cache.breakpoint_for(0.05f));
+
+    // Above the reference the curve is flat and stays put
+    cache.follow(writer, 0.9f);
+    int pins = writer.pins;
+    cache.follow(writer, 1.0f);
+    ASSERT_EQ(writer.pins, pins);
+
+    // A rebuild rewrites at the same volume
+    ASSERT_TRUE(cache.build(settings, 44100.0f));
+    ASSERT_TRUE(cache.follow(writer, 1.0f) != 0);
+    ASSERT_EQ(writer.pins, pins + 2);
+}
+
+TEST(loudness_rejects_invalid_settings) {
+    tas5805m_loudness::LoudnessCache cache;
+    tas5805m_loudness::LoudnessSettings settings;
+
+    settings.breakpoints = tas5805m_loudness::MAX_BREAKPOINTS + 1;
+    ASSERT_FALSE(cache.build(settings, 48000.0f));
+    settings = tas5805m_loudness::LoudnessSettings();
+    settings.treble_frequency = 30000.0f;
+    ASSERT_FALSE(cache.build(settings, 48000.0f));
+    settings = tas5805m_loudness::LoudnessSettings();
+    settings.reference_volume = 0.0f;
+    ASSERT_FALSE(cache.build(settings, 48000.0f));
+    ASSERT_FALSE(cache.ready());
+
+    // Not built: volume changes are recorded but nothing is written
+    FakeWriter writer;
+    ASSERT_EQ(cache.follow(writer, 0.1f), 0u);
+    ASSERT_EQ(writer.pins, 0);
+    ASSERT_NEAR(cache.last_volume(), 0.1f, 1e-6f);
+
+    // Built but not placed: still nothing written
+    ASSERT_TRUE(cache.build(tas5805m_loudness::LoudnessSettings(), 48000.0f));
+    ASSERT_EQ(cache.follow(writer, 0.0f), 0u);
+    ASSERT_EQ(writer.pins, 0);
+}
+
+TEST(loudness_stays_out_of_profile_slots) {
+    tas5805m_loudness::LoudnessCache cache;
+    FakeWriter writer;
+    build_loudness(cache, writer, 48000.0f);
+    cache.follow(writer, 0.0f);
+    ASSERT_EQ(writer.pinned, (1u << 13) | (1u << 14));
+
+    // A profile in 0-12 leaves the shelves where they are
+    uint16_t released = 0xFFFF;
+    ASSERT_TRUE(cache.fit(writer, 0x1FFF, released));
+    ASSERT_EQ(released, 0);
+    ASSERT_EQ(cache.follow(writer, 0.0f), 0u);
+
+    // The profile now needs 13 but frees 11: the shelves take 11 and 14,
+    // and only 13 is handed back
+    uint16_t used = (0x1FFF & ~(1u << 11)) | (1u << 13);
+    ASSERT_TRUE(cache.fit(writer, used, released));
+    ASSERT_EQ(cache.bass_slot(), 11);
+    ASSERT_EQ(cache.treble_slot(), 14);
+    ASSERT_EQ(released, 1u << 13);
+    ASSERT_EQ(writer.pinned, 0);   // Re-pinned by the next follow()
+    ASSERT_TRUE(cache.follow(writer, 0.0f) != 0);   // Same volume, new slots
+    ASSERT_EQ(writer.pinned, (1u << 11) | (1u << 14));
+    ASSERT_TRUE(memcmp(writer.slots[11], cache.wire(cache.current(), 0), tas5805m_biquad::BIQUAD_WIRE_BYTES) == 0);
+
+    // Fewer than two free slots: loudness turns off and gives both back
+    ASSERT_FALSE(cache.fit(writer, 0x7FFF & ~(1u << 3), released));
+    ASSERT_EQ(released, (1u << 11) | (1u << 14));
+    ASSERT_EQ(writer.pinned, 0);
+    ASSERT_FALSE(cache.ready());
+    ASSERT_FALSE(cache.placed());
+
+    // Disabled (invalidated) while placed: the next fit releases the slots
+    build_loudness(cache, writer, 48000.0f);
+    cache.follow(writer, 0.5f);
+    cache.invalidate();
+    ASSERT_TRUE(cache.fit(writer, 0, released));
+    ASSERT_EQ(released, (1u << 13) | (1u << 14));
+    ASSERT_EQ(writer.pinned, 0);
+}
+
 // =============================================================================
 // TESTS: EDGE CASES AND NUMERICAL STABILITY
 // =============================================================================
@@ -802,6 +986,33 @@ TEST(filter_at_nyquist) {
     ASSERT_TRUE(coeffs_are_stable(c));
 }
 
+TEST(filter_design_matches_calculators) {
+    using tas5805m_biquad::FilterDesign;
+    using tas5805m_biquad::FilterType;
+
+    for (float fs : {44100.0f, 48000.0f, 96000.0f}) {
+        BiquadCoeffs c;
+        ASSERT_TRUE(tas5805m_biquad::calc_filter(FilterDesign(FilterType::PEAKING, 63.0f, -4.5f, 3.0f), fs, c));
+        BiquadCoeffs peq = tas5805m_biquad::calc_parametric_eq(63.0f, -4.5f, 3.0f, fs);
+        ASSERT_EQ(memcmp(&c, &peq, sizeof(c)), 0);
+        ASSERT_TRUE(tas5805m_biquad::calc_filter(FilterDesign(FilterType::LOW_SHELF, 120.0f, 3.0f, 0.8f), fs, c));
+        BiquadCoeffs shelf = tas5805m_biquad::calc_low_shelf(120.0f, 3.0f, 0.8f, fs);
+        ASSERT_EQ(memcmp(&c, &shelf, sizeof(c)), 0);
+        ASSERT_TRUE(tas5805m_biquad::calc_filter(FilterDesign(FilterType::HIGHPASS, 25.0f, 0.0f, 0.7071f), fs, c));
+        BiquadCoeffs hp = tas5805m_biquad::calc_highpass(25.0f, 0.7071f, fs);
+        ASSERT_EQ(memcmp(&c, &hp, sizeof(c)), 0);
+    }
+
+    // RAW has no design, and a band at or above Nyquist can't be designed
+    BiquadCoeffs untouched;
+    ASSERT_FALSE(tas5805m_biquad::calc_filter(FilterDesign(), 48000.0f, untouched));
+    ASSERT_FALSE(tas5805m_biquad::calc_filter(FilterDesign(FilterType::LOWPASS, 23000.0f, 0.0f, 0.7f), 44100.0f,
+                                              untouched));
+    ASSERT_TRUE(untouched.is_bypass());
+    ASSERT_TRUE(tas5805m_biquad::calc_filter(FilterDesign(FilterType::LOWPASS, 23000.0f, 0.0f, 0.7f), 48000.0f,
+                                             untouched));
+}
+
 TEST(filter_very_low_frequency) {
     // Very low frequency filter
     auto c = tas5805m_biquad::calc_highpass(10.0f, 0.707f, 48000.0f);
@@ -0,0 +1,1458 @@
+/**
+ * Bus-Level Tests for TAS5805M Biquad Writes and Profile Apply
+ *
+ * Runs the real tas5805m_biquad_i2c.h / tas5805m_profile_manager.h against
+ * the recording I2C mock in host_mock/, which emulates the chip's register
+ * map and models 400 kHz bus time plus delay() sleeps. Besides checking what
+ * lands in coefficient memory, the tests hold the apply paths to transaction
+ * and latency budgets.
+ *
+ * Build and run:
+ *   g++ -std=c++17 -Ihost_mock -o test_tas5805m_i2c test_tas5805m_i2c.cpp -lm && ./test_tas5805m_i2c
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <set>
+
+#include "tas5805m_profile_manager.h"
+#include "tas5805m_coeff_writer.h"
+#include "tas5805m_loudness.h"
+
+using namespace tas5805m_biquad;
+using esphome::i2c::I2CBus;
+
+// =============================================================================
+// TEST FRAMEWORK
+// =============================================================================
+
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) \
+    void test_##name(); \
+    struct TestRegistrar_##name { \
+        TestRegistrar_##name() { \
+            printf("  Running: %s ... ", #name); \
+            fflush(stdout); \
+            tests_run++; \
+            try { \
+                test_##name(); \
+                printf("PASSED\n"); \
+                tests_passed++; \
+            } catch (const char* msg) { \
+                printf("FAILED: %s\n", msg); \
+                tests_failed++; \
+            } \
+        } \
+    } test_registrar_##name; \
+    void test_##name()
+
+#define ASSERT_TRUE(expr) \
+    if (!(expr)) throw "ASSERT_TRUE failed: " #expr
+
+#define ASSERT_FALSE(expr) \
+    if (expr) throw "ASSERT_FALSE failed: " #expr
+
+#define ASSERT_EQ(a, b) \
+    if ((a) != (b)) throw "ASSERT_EQ failed: " #a " != " #b
+
+// =============================================================================
+// BUDGETS
+// =============================================================================
+
+// Full 30-biquad apply: 8 page bursts + book/page selects
+constexpr uint32_t FULL_APPLY_MAX_TRANSACTIONS = 20;
+constexpr double FULL_APPLY_MAX_MS = 30.0;
+
+// Single biquad edit: page 0, book, page, data, back to page 0 / book 0
+constexpr uint32_t SINGLE_EDIT_MAX_TRANSACTIONS = 6;
+constexpr double SINGLE_EDIT_MAX_MS = 20.0;
+
+// =============================================================================
+// HELPERS
+// =============================================================================
+
+static constexpr uint8_t ADDR = TAS5805M_ADDR;
+
+/**
+ * Fresh chip and fresh driver state: nothing known about the DSP contents
+ */
+static void reset_state(I2CBus& bus) {
+    invalidate_coeff_shadow();
+    invalidate_register_cursor();
+    g_register_cursor.address = -1;
+    retry_policy() = RetryPolicy();
+    bus_health().reset();
+    bus.fail_next = 0;
+    bus.reset_counters();
+}
+
+/**
+ * Coefficient pages (book 0xAA) that received data writes
+ */
+static std::set<uint8_t> coeff_pages_written(const I2CBus& bus) {
+    std::set<uint8_t> pages;
+    for (const auto& t : bus.log) {
+        if (t.read || t.result != esphome::i2c::ERROR_OK || t.data.size() < 2) continue;
+        if (t.data[0] == REG_PAGE_SELECT || t.data[0] == REG_BOOK_SELECT) continue;
+        if (t.book == BOOK_COEFF) pages.insert(t.page);
+    }
+    return pages;
+}
+
+/**
+ * Does coefficient memory hold the packed form of c at (channel, index)?
+ */
+static bool chip_holds(const I2CBus& bus, int channel, int index, const BiquadCoeffs& c) {
+    uint8_t expected[BIQUAD_WIRE_BYTES];
+    pack_biquad(c, expected);
+    for (size_t i = 0; i < BIQUAD_WIRE_BYTES; i++) {
+        if (bus.peek(BOOK_COEFF, biquad_page(channel, index), OFFSET_BQ[index] + i) != expected[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool chip_at_book0(const I2CBus& bus) {
+    return bus.book() == 0x00 && bus.page() == 0x00;
+}
+
+/**
+ * Do two biquads pack to the same wire bytes?
+ */
+static bool same_wire(const BiquadCoeffs& a, const BiquadCoeffs& b) {
+    uint8_t wa[BIQUAD_WIRE_BYTES], wb[BIQUAD_WIRE_BYTES];
+    pack_biquad(a, wa);
+    pack_biquad(b, wb);
+    return memcmp(wa, wb, BIQUAD_WIRE_BYTES) == 0;
+}
+
+/**
+ * NVS key hash used by the profile manager (FNV-1a)
+ */
+static uint32_t nvs_key(const char* str) {
+    uint32_t hash = 2166136261u;
+    while (*str) {
+        hash ^= static_cast<uint8_t>(*str++);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void make_profile(BiquadCoeffs left[15], BiquadCoeffs right[15]) {
+    for (int i = 0; i < 15; i++) {
+        left[i] = calc_parametric_eq(40.0f * (i + 1), -3.0f, 2.0f);
+        right[i] = calc_parametric_eq(45.0f * (i + 1), -2.0f, 2.0f);
+    }
+}
+
+// =============================================================================
+// TIMING MODEL
+// =============================================================================
+
+TEST(timing_model_counts_bits_and_sleeps) {
+    I2CBus bus;
+    bus.reset_counters();
+
+    uint8_t frame[3] = {0x10, 0x01, 0x02};
+    bus.write(ADDR, frame, 3, true);
+    ASSERT_EQ(bus.bus_bits, 2u + 9u * 4u);
+
+    delay(7);
+    double expected = (2.0 + 9.0 * 4.0) * 1000.0 / I2CBus::BUS_HZ + 7.0;
+    ASSERT_TRUE(std::fabs(bus.modeled_ms() - expected) < 1e-9);
+}
+
+// =============================================================================
+// SINGLE BIQUAD WRITES
+// =============================================================================
+
+TEST(single_peq_edit_hits_one_page) {
+    I2CBus bus;
+    reset_state(bus);
+
+    auto c = calc_parametric_eq(1000.0f, -4.0f, 2.0f);
+    ASSERT_TRUE(write_coeffs(&bus, ADDR, 0, 5, c, nullptr));
+
+    auto pages = coeff_pages_written(bus);
+    ASSERT_EQ(pages.size(), 1u);
+    ASSERT_EQ(*pages.begin(), PAGE_LEFT_BQ[5]);
+    ASSERT_TRUE(chip_holds(bus, 0, 5, c));
+    ASSERT_TRUE(chip_at_book0(bus));
+    ASSERT_TRUE(bus.transactions() <= SINGLE_EDIT_MAX_TRANSACTIONS);
+    ASSERT_TRUE(bus.modeled_ms() < SINGLE_EDIT_MAX_MS);
+}
+
+TEST(stereo_edit_hits_one_page_per_channel) {
+    I2CBus bus;
+    reset_state(bus);
+
+    auto c = calc_low_shelf(100.0f, 3.0f);
+    ASSERT_TRUE(write_coeffs(&bus, ADDR, 2, 9, c, nullptr));
+
+    auto pages = coeff_pages_written(bus);
+    ASSERT_EQ(pages.size(), 2u);
+    ASSERT_TRUE(pages.count(PAGE_LEFT_BQ[9]) == 1);
+    ASSERT_TRUE(pages.count(PAGE_RIGHT_BQ[9]) == 1);
+    ASSERT_TRUE(chip_holds(bus, 0, 9, c));
+    ASSERT_TRUE(chip_holds(bus, 1, 9, c));
+    ASSERT_TRUE(chip_at_book0(bus));
+
+    // Both channels in one sweep with a single settle
+    ASSERT_TRUE(bus.modeled_ms() < SINGLE_EDIT_MAX_MS);
+}
+
+TEST(page_write_rejects_pages_without_those_biquads) {
+    I2CBus bus;
+    reset_state(bus);
+
+    BiquadCoeffs c[4];
+    for (int i = 0; i < 4; i++) c[i] = calc_parametric_eq(500.0f * (i + 1), -2.0f, 1.5f);
+
+    TAS5805M_I2C dev(&bus, ADDR);
+    ASSERT_FALSE(write_biquads_page(dev, 0x28, c, 4));
+    ASSERT_FALSE(write_biquads_page(dev, 0x23, c, 1));
+    ASSERT_FALSE(write_biquads_page(dev, PAGE_LEFT_BQ[12], c, 3, 1));  // No BQ15
+    ASSERT_FALSE(write_biquads_page(dev, PAGE_RIGHT_BQ[12], c, 4));
+    ASSERT_EQ(bus.transactions(), 0u);
+
+    // The last right page takes its three biquads
+    ASSERT_TRUE(write_biquads_page(dev, PAGE_RIGHT_BQ[12], c, 3));
+    dev.return_to_normal();
+    for (int i = 0; i < 3; i++) ASSERT_TRUE(chip_holds(bus, 1, 12 + i, c[i]));
+    ASSERT_TRUE(chip_at_book0(bus));
+}
+
+TEST(unchanged_edit_sends_nothing) {
+    I2CBus bus;
+    reset_state(bus);
+
+    auto c = calc_notch(60.0f, 10.0f);
+    ASSERT_TRUE(write_coeffs(&bus, ADDR, 0, 3, c, nullptr));
+
+    bus.reset_counters();
+    ASSERT_TRUE(write_coeffs(&bus, ADDR, 0, 3, c, nullptr));
+    ASSERT_EQ(bus.transactions(), 0u);
+    ASSERT_TRUE(bus.modeled_ms() < 1e-9);
+
+    // A bad channel is an error, not "unchanged"
+    ASSERT_FALSE(write_biquad(&bus, ADDR, 3, 3, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f));
+    ASSERT_FALSE(reset_biquad(&bus, ADDR, -1, 3));
+    ASSERT_EQ(bus.transactions(), 0u);
+}
+
+TEST(retry_recovers_with_sub_ms_backoff) {
+    I2CBus bus;
+    reset_state(bus);
+
+    auto c = calc_highpass(30.0f, 0.7071f);
+    ASSERT_TRUE(write_coeffs(&bus, ADDR, 0, 0, c, nullptr));
+    double clean_ms = bus.modeled_ms();
+    double clean_ms_sleep = bus.sleep_ms();
+    uint32_t clean_transactions = bus.transactions();
+
+    reset_state(bus);
+    bus.fail_next = 1;
+    ASSERT_TRUE(write_coeffs(&bus, ADDR, 0, 0, c, nullptr));
+    ASSERT_TRUE(chip_holds(bus, 0, 0, c));
+    ASSERT_EQ(bus.transactions(), clean_transactions + 1);
+    ASSERT_TRUE(std::fabs(bus.sleep_ms() - clean_ms_sleep - 0.25) < 1e-9);
+    ASSERT_TRUE(bus.modeled_ms() < clean_ms + 1.0);
+}
+
+TEST(retry_backoff_is_exponential) {
+    I2CBus bus;
+    reset_state(bus);
+
+    uint8_t frame[1] = {0x55};
+    TAS5805M_I2C dev(&bus, ADDR);
+    bus.fail_next = 2;
+    ASSERT_TRUE(dev.write_bytes(0x10, frame, 1));
+    ASSERT_EQ(bus.transactions(), 3u);
+    ASSERT_TRUE(std::fabs(bus.sleep_ms() - (0.25 + 1.0)) < 1e-9);
+
+    // Three failures: the transfer gives up after max_attempts
+    bus.reset_counters();
+    bus.fail_next = 3;
+    ASSERT_FALSE(dev.write_bytes(0x10, frame, 1));
+    ASSERT_EQ(bus.transactions(), 3u);
+}
+
+TEST(failed_write_reports_and_recovers) {
+    I2CBus bus;
+    reset_state(bus);
+
+    // All three attempts of the first select fail
+    bus.fail_next = 3;
+    ASSERT_EQ(bus_health().last_failed_reg(), -1);
+    ASSERT_FALSE(write_coeffs(&bus, ADDR, 0, 0, BiquadCoeffs(), nullptr));
+    ASSERT_TRUE(coeff_pages_written(bus).empty());
+    ASSERT_EQ(bus_health().last_failed_reg(), (int)REG_PAGE_SELECT);
+
+    bus.reset_counters();
+    auto c = calc_lowpass(15000.0f, 0.7071f);
+    ASSERT_TRUE(write_coeffs(&bus, ADDR, 0, 0, c, nullptr));
+    ASSERT_TRUE(chip_holds(bus, 0, 0, c));
+    ASSERT_TRUE(chip_at_book0(bus));
+}
+
+TEST(breaker_fails_fast_and_recovers) {
+    I2CBus bus;
+    reset_state(bus);
+    const RetryPolicy& policy = retry_policy();
+
+    // Chip stops answering: each transfer fails all its attempts
+    bus.fail_next = 1000;
+    TAS5805M_I2C dev(&bus, ADDR);
+    for (int i = 0; i < policy.breaker_threshold; i++) {
+        ASSERT_FALSE(dev.write_byte(0x10, 0x00));
+    }
+    ASSERT_TRUE(bus_health().state() == BreakerState::OPEN);
+
+    // While open nothing reaches the bus
+    bus.reset_counters();
+    ASSERT_FALSE(write_coeffs(&bus, ADDR, 2, 4, calc_notch(50.0f, 10.0f), nullptr));
+    ASSERT_EQ(bus.transactions(), 0u);
+
+    // Still dead after the cooldown: one probe attempt, then a longer cooldown
+    delay(policy.breaker_cooldown_ms);
+    bus.reset_counters();
+    ASSERT_FALSE(dev.write_byte(0x10, 0x00));
+    ASSERT_EQ(bus.transactions(), 1u);
+    ASSERT_TRUE(bus_health().state() == BreakerState::OPEN);
+    ASSERT_EQ(bus_health().cooldown_remaining_ms(), policy.breaker_cooldown_ms * 2);
+
+    // Chip back: the probe succeeds and closes the breaker
+    bus.fail_next = 0;
+    delay(policy.breaker_cooldown_ms * 2);
+    ASSERT_TRUE(dev.write_byte(0x10, 0x00));
+    ASSERT_TRUE(bus_health().state() == BreakerState::CLOSED);
+}
+
+TEST(failure_budget_aborts_apply_early) {
+    I2CBus bus;
+    reset_state(bus);
+    tas5805m_perf::perf_stats().reset();
+
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+
+    // Dead bus during a full apply: the budget stops it after a handful of
+    // attempts instead of 20 transfers x 3 attempts
+    bus.fail_next = 1000;
+    ASSERT_FALSE(write_all_biquads_batched(&bus, ADDR, left, right));
+    ASSERT_TRUE(bus.transactions() <= 10u);
+    ASSERT_TRUE(bus.modeled_ms() < 10.0);
+
+    auto i2c = tas5805m_perf::perf_stats().i2c();
+    ASSERT_EQ(i2c.budget_aborts, 1u);
+    ASSERT_TRUE(i2c.fast_failures > 0u);
+    ASSERT_EQ(i2c.breaker_trips, 1u);
+}
+
+// =============================================================================
+// FULL PROFILE APPLY
+// =============================================================================
+
+TEST(batched_apply_within_budget) {
+    I2CBus bus;
+    reset_state(bus);
+
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+    ASSERT_TRUE(write_all_biquads_batched(&bus, ADDR, left, right));
+
+    for (int i = 0; i < 15; i++) {
+        ASSERT_TRUE(chip_holds(bus, 0, i, left[i]));
+        ASSERT_TRUE(chip_holds(bus, 1, i, right[i]));
+    }
+    ASSERT_EQ(coeff_pages_written(bus).size(), 8u);
+    ASSERT_TRUE(chip_at_book0(bus));
+    ASSERT_TRUE(bus.transactions() <= FULL_APPLY_MAX_TRANSACTIONS);
+    ASSERT_TRUE(bus.modeled_ms() < FULL_APPLY_MAX_MS);
+}
+
+TEST(batched_apply_beats_per_biquad_writes) {
+    I2CBus bus;
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+
+    reset_state(bus);
+    for (int i = 0; i < 15; i++) {
+        ASSERT_TRUE(write_coeffs(&bus, ADDR, 0, i, left[i], nullptr));
+        ASSERT_TRUE(write_coeffs(&bus, ADDR, 1, i, right[i], nullptr));
+    }
+    double single_ms = bus.modeled_ms();
+
+    reset_state(bus);
+    ASSERT_TRUE(write_all_biquads_batched(&bus, ADDR, left, right));
+    ASSERT_TRUE(bus.modeled_ms() * 5.0 < single_ms);
+}
+
+TEST(delta_reapply_is_free) {
+    I2CBus bus;
+    reset_state(bus);
+
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+    ASSERT_TRUE(write_all_biquads_delta(&bus, ADDR, left, right));
+    ASSERT_TRUE(bus.transactions() <= FULL_APPLY_MAX_TRANSACTIONS);
+
+    bus.reset_counters();
+    ASSERT_TRUE(write_all_biquads_delta(&bus, ADDR, left, right));
+    ASSERT_EQ(bus.transactions(), 0u);
+
+    // One changed biquad costs one page burst
+    left[6] = calc_parametric_eq(333.0f, 1.0f, 1.0f);
+    bus.reset_counters();
+    ASSERT_TRUE(write_all_biquads_delta(&bus, ADDR, left, right));
+    ASSERT_EQ(coeff_pages_written(bus).size(), 1u);
+    ASSERT_TRUE(chip_holds(bus, 0, 6, left[6]));
+    ASSERT_TRUE(bus.transactions() <= SINGLE_EDIT_MAX_TRANSACTIONS);
+}
+
+TEST(linked_apply_writes_both_channels) {
+    I2CBus bus;
+    reset_state(bus);
+
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+    ASSERT_TRUE(write_all_biquads_linked(&bus, ADDR, left));
+
+    for (int i = 0; i < 15; i++) {
+        ASSERT_TRUE(chip_holds(bus, 0, i, left[i]));
+        ASSERT_TRUE(chip_holds(bus, 1, i, left[i]));
+    }
+    ASSERT_EQ(coeff_pages_written(bus).size(), 8u);
+    ASSERT_TRUE(chip_at_book0(bus));
+    ASSERT_TRUE(bus.transactions() <= FULL_APPLY_MAX_TRANSACTIONS);
+
+    // Identical sets are detected by the two-channel writers too
+    bus.reset_counters();
+    ASSERT_TRUE(write_all_biquads_delta(&bus, ADDR, left, left));
+    ASSERT_EQ(bus.transactions(), 0u);
+}
+
+TEST(atomic_apply_mutes_and_restores_ctrl2) {
+    I2CBus bus;
+    reset_state(bus);
+    bus.poke(0x00, 0x00, REG_DEVICE_CTRL2, 0x03);  // Play
+
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+    ASSERT_TRUE(write_all_biquads_atomic(&bus, ADDR, left, right));
+
+    bool muted = false;
+    for (const auto& t : bus.log) {
+        if (!t.read && t.book == 0 && t.page == 0 && t.data.size() == 2 &&
+            t.data[0] == REG_DEVICE_CTRL2 && t.data[1] == (0x03 | DEVICE_CTRL2_MUTE)) {
+            muted = true;
+        }
+    }
+    ASSERT_TRUE(muted);
+    ASSERT_EQ(bus.peek(0x00, 0x00, REG_DEVICE_CTRL2), 0x03);
+    ASSERT_TRUE(chip_holds(bus, 1, 14, right[14]));
+    ASSERT_TRUE(chip_at_book0(bus));
+    ASSERT_TRUE(bus.modeled_ms() < FULL_APPLY_MAX_MS + DELAY_MUTE_RAMP_MS);
+}
+
+TEST(atomic_apply_keeps_ctrl2_changes_made_meanwhile) {
+    I2CBus bus;
+    reset_state(bus);
+    bus.poke(0x00, 0x00, REG_DEVICE_CTRL2, 0x03);  // Play
+
+    // The driver switches to Hi-Z while the coefficients go out
+    bus.on_write = [](I2CBus& b, const I2CBus::Transaction& t) {
+        if (t.book == BOOK_COEFF && t.data[0] != REG_PAGE_SELECT) {
+            b.poke(0x00, 0x00, REG_DEVICE_CTRL2, 0x02 | DEVICE_CTRL2_MUTE);
+            b.on_write = nullptr;
+        }
+    };
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+    ASSERT_TRUE(write_all_biquads_atomic(&bus, ADDR, left, right));
+    ASSERT_EQ(bus.peek(0x00, 0x00, REG_DEVICE_CTRL2), 0x02);
+
+    // Already muted: coefficients are written, the output stays muted, no ramp
+    reset_state(bus);
+    bus.poke(0x00, 0x00, REG_DEVICE_CTRL2, 0x03 | DEVICE_CTRL2_MUTE);
+    BiquadCoeffs flat[15];
+    ASSERT_TRUE(write_all_biquads_atomic(&bus, ADDR, flat, flat));
+    ASSERT_TRUE(chip_holds(bus, 0, 0, flat[0]));
+    ASSERT_EQ(bus.peek(0x00, 0x00, REG_DEVICE_CTRL2), 0x03 | DEVICE_CTRL2_MUTE);
+    ASSERT_TRUE(bus.sleep_ms() < DELAY_MUTE_RAMP_MS);
+    ASSERT_TRUE(chip_at_book0(bus));
+}
+
+// =============================================================================
+// READBACK AND VERIFY
+// =============================================================================
+
+TEST(verify_clean_chip_reads_each_page_once) {
+    I2CBus bus;
+    reset_state(bus);
+
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+    ASSERT_TRUE(write_all_biquads_batched(&bus, ADDR, left, right));
+
+    bus.reset_counters();
+    VerifyResult result;
+    ASSERT_TRUE(verify_coeff_shadow(&bus, ADDR, true, &result));
+    ASSERT_EQ(result.checked, 30);
+    ASSERT_EQ(result.mismatched, 0);
+    ASSERT_EQ(bus.read_count, 8u);
+    ASSERT_TRUE(coeff_pages_written(bus).empty());
+    ASSERT_TRUE(chip_at_book0(bus));
+    ASSERT_TRUE(bus.modeled_ms() < FULL_APPLY_MAX_MS);
+}
+
+TEST(verify_repairs_only_corrupted_biquads) {
+    I2CBus bus;
+    reset_state(bus);
+
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+    ASSERT_TRUE(write_all_biquads_batched(&bus, ADDR, left, right));
+
+    // Something rewrote two biquads behind the shadow's back
+    bus.poke(BOOK_COEFF, biquad_page(0, 5), OFFSET_BQ[5] + 3, 0x5A);
+    bus.poke(BOOK_COEFF, biquad_page(1, 14), OFFSET_BQ[14], 0x7E);
+
+    bus.reset_counters();
+    VerifyResult result;
+    ASSERT_TRUE(verify_coeff_shadow(&bus, ADDR, true, &result));
+    ASSERT_EQ(result.mismatched, 2);
+    ASSERT_EQ(result.repaired, 2);
+    ASSERT_EQ(result.mismatch_mask[0], 1u << 5);
+    ASSERT_EQ(result.mismatch_mask[1], 1u << 14);
+    ASSERT_TRUE(chip_holds(bus, 0, 5, left[5]));
+    ASSERT_TRUE(chip_holds(bus, 1, 14, right[14]));
+    ASSERT_EQ(coeff_pages_written(bus).size(), 2u);
+    ASSERT_TRUE(chip_at_book0(bus));
+
+    // Repaired and in sync: a re-apply sends nothing
+    bus.reset_counters();
+    ASSERT_TRUE(write_all_biquads_delta(&bus, ADDR, left, right));
+    ASSERT_EQ(bus.transactions(), 0u);
+}
+
+TEST(verify_report_only_resyncs_shadow) {
+    I2CBus bus;
+    reset_state(bus);
+
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+    uint8_t wire[2][BIQUADS_PER_CHANNEL * BIQUAD_WIRE_BYTES];
+    for (size_t i = 0; i < BIQUADS_PER_CHANNEL; i++) {
+        pack_biquad(left[i], &wire[0][i * BIQUAD_WIRE_BYTES]);
+        pack_biquad(right[i], &wire[1][i * BIQUAD_WIRE_BYTES]);
+    }
+    ASSERT_TRUE(write_all_biquads_wire(&bus, ADDR, wire));
+    bus.poke(BOOK_COEFF, biquad_page(0, 9), OFFSET_BQ[9] + 7, 0xFF);
+
+    bus.reset_counters();
+    VerifyResult result;
+    ASSERT_TRUE(verify_all_biquads_wire(&bus, ADDR, wire, false, &result));
+    ASSERT_EQ(result.mismatched, 1);
+    ASSERT_EQ(result.repaired, 0);
+    ASSERT_TRUE(coeff_pages_written(bus).empty());
+    ASSERT_FALSE(chip_holds(bus, 0, 9, left[9]));
+
+    // The shadow now mirrors the chip, so the next delta write fixes just that biquad
+    bus.reset_counters();
+    ASSERT_TRUE(write_all_biquads_wire(&bus, ADDR, wire));
+    ASSERT_TRUE(chip_holds(bus, 0, 9, left[9]));
+    ASSERT_EQ(coeff_pages_written(bus).size(), 1u);
+}
+
+TEST(verify_learns_unknown_slots) {
+    I2CBus bus;
+    reset_state(bus);
+
+    VerifyResult result;
+    ASSERT_TRUE(verify_coeff_shadow(&bus, ADDR, true, &result));
+    ASSERT_EQ(result.checked, 0);
+    ASSERT_EQ(result.learned, 30);
+    ASSERT_TRUE(coeff_shadow().is_known(1, 14));
+}
+
+TEST(capture_profile_from_chip) {
+    I2CBus bus;
+    reset_state(bus);
+
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+    left[14] = BiquadCoeffs();
+    right[14] = BiquadCoeffs();
+    ASSERT_TRUE(write_all_biquads_batched(&bus, ADDR, left, right));
+
+    bus.reset_counters();
+    tas5805m_profile::CalibrationProfile profile;
+    ASSERT_TRUE(tas5805m_profile::create_profile_from_current_state(&bus, ADDR, profile));
+    ASSERT_EQ(bus.read_count, 8u);
+    ASSERT_TRUE(profile.is_valid());
+    ASSERT_EQ(profile.num_filters_used, 14);
+    for (int i = 0; i < 15; i++) {
+        ASSERT_TRUE(std::fabs(profile.left_channel[i].b0 - left[i].b0) < 1e-6f);
+        ASSERT_TRUE(std::fabs(profile.left_channel[i].a1 - left[i].a1) < 1e-6f);
+        ASSERT_TRUE(std::fabs(profile.right_channel[i].a2 - right[i].a2) < 1e-6f);
+    }
+
+    // A failed read leaves the caller's profile alone
+    reset_state(bus);
+    bus.fail_next = 100;
+    tas5805m_profile::CalibrationProfile untouched;
+    ASSERT_FALSE(tas5805m_profile::create_profile_from_current_state(&bus, ADDR, untouched));
+    ASSERT_EQ(untouched.num_filters_used, 0);
+}
+
+// =============================================================================
+// PROFILE MANAGER
+// =============================================================================
+
+TEST(boot_apply_from_image_within_budget) {
+    I2CBus bus;
+    reset_state(bus);
+    esphome::global_preferences->clear();
+
+    tas5805m_profile::ProfileManager manager;
+    manager.setup();
+
+    tas5805m_profile::CalibrationProfile profile;
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+    for (int i = 0; i < 15; i++) {
+        profile.left_channel[i] = left[i];
+        profile.right_channel[i] = right[i];
+    }
+    ASSERT_TRUE(manager.save_profile("Living Room", profile));
+    ASSERT_TRUE(manager.set_active_profile("Living Room"));
+    ASSERT_EQ(bus.transactions(), 0u);
+
+    ASSERT_TRUE(manager.load_and_apply_active_profile(&bus, ADDR));
+    for (int i = 0; i < 15; i++) {
+        ASSERT_TRUE(chip_holds(bus, 0, i, left[i]));
+        ASSERT_TRUE(chip_holds(bus, 1, i, right[i]));
+    }
+    ASSERT_TRUE(chip_at_book0(bus));
+    ASSERT_TRUE(bus.transactions() <= FULL_APPLY_MAX_TRANSACTIONS);
+    ASSERT_TRUE(bus.modeled_ms() < FULL_APPLY_MAX_MS);
+
+    // Applying it again (e.g. load_profile of the active one) is free
+    bus.reset_counters();
+    ASSERT_TRUE(manager.load_and_apply_active_profile(&bus, ADDR));
+    ASSERT_EQ(bus.transactions(), 0u);
+}
+
+TEST(boot_apply_runs_once_and_records_time) {
+    I2CBus bus;
+    reset_state(bus);
+    esphome::global_preferences->clear();
+
+    tas5805m_profile::ProfileManager manager;
+    manager.setup();
+
+    tas5805m_profile::CalibrationProfile profile;
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+    for (int i = 0; i < 15; i++) {
+        profile.left_channel[i] = left[i];
+        profile.right_channel[i] = right[i];
+    }
+    ASSERT_TRUE(manager.save_profile("Living Room", profile));
+    ASSERT_TRUE(manager.set_active_profile("Living Room"));
+
+    // Chip not answering yet: nothing recorded, a later stage retries
+    bus.fail_next = 1000;
+    ASSERT_FALSE(manager.apply_at_boot(&bus, ADDR));
+    ASSERT_FALSE(manager.boot_applied());
+    ASSERT_EQ(manager.boot_corrected_ms(), 0u);
+
+    reset_state(bus);
+    ASSERT_TRUE(manager.apply_at_boot(&bus, ADDR));
+    ASSERT_TRUE(manager.boot_applied());
+    ASSERT_EQ(manager.boot_corrected_ms(), esphome::millis());
+    ASSERT_TRUE(manager.boot_apply_ms() > 0u);
+    ASSERT_TRUE(manager.boot_apply_ms() < FULL_APPLY_MAX_MS);
+    for (int i = 0; i < 15; i++) {
+        ASSERT_TRUE(chip_holds(bus, 0, i, left[i]));
+        ASSERT_TRUE(chip_holds(bus, 1, i, right[i]));
+    }
+
+    // The later stage's call is free, even after the shadow is lost
+    invalidate_coeff_shadow();
+    bus.reset_counters();
+    ASSERT_TRUE(manager.apply_at_boot(&bus, ADDR));
+    ASSERT_EQ(bus.transactions(), 0u);
+
+    // Without an active profile there is no correction to time
+    tas5805m_profile::ProfileManager empty;
+    ASSERT_TRUE(empty.apply_at_boot(&bus, ADDR));
+    ASSERT_EQ(empty.boot_corrected_ms(), 0u);
+}
+
+TEST(boot_retry_runs_despite_open_breaker) {
+    I2CBus bus;
+    reset_state(bus);
+    esphome::global_preferences->clear();
+
+    tas5805m_profile::ProfileManager manager;
+    manager.setup();
+
+    tas5805m_profile::CalibrationProfile profile;
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+    for (int i = 0; i < 15; i++) {
+        profile.left_channel[i] = left[i];
+        profile.right_channel[i] = right[i];
+    }
+    ASSERT_TRUE(manager.save_profile("Living Room", profile));
+    ASSERT_TRUE(manager.set_active_profile("Living Room"));
+
+    // The early attempt fails and trips the breaker
+    bus.fail_next = 12;
+    ASSERT_FALSE(manager.apply_at_boot(&bus, ADDR));
+    ASSERT_TRUE(bus_health().state() == BreakerState::OPEN);
+    ASSERT_TRUE(bus_health().cooldown_remaining_ms() > 0u);
+    int failed_reg = bus_health().last_failed_reg();
+
+    // The chip is up by the later stage, well within the cooldown
+    bus.fail_next = 0;
+    ASSERT_TRUE(manager.apply_at_boot(&bus, ADDR));
+    ASSERT_TRUE(manager.boot_applied());
+    ASSERT_TRUE(bus_health().state() == BreakerState::CLOSED);
+    ASSERT_EQ(bus_health().last_failed_reg(), failed_reg);
+    for (int i = 0; i < 15; i++) {
+        ASSERT_TRUE(chip_holds(bus, 0, i, left[i]));
+        ASSERT_TRUE(chip_holds(bus, 1, i, right[i]));
+    }
+    ASSERT_TRUE(chip_at_book0(bus));
+}
+
+TEST(linked_profile_stored_once) {
+    I2CBus bus;
+    reset_state(bus);
+    esphome::global_preferences->clear();
+
+    tas5805m_profile::ProfileManager manager;
+    manager.setup();
+
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+    tas5805m_profile::CalibrationProfile stereo, linked;
+    for (int i = 0; i < 15; i++) {
+        stereo.left_channel[i] = left[i];
+        stereo.right_channel[i] = right[i];
+        linked.left_channel[i] = left[i];
+        linked.right_channel[i] = left[i];
+    }
+    ASSERT_TRUE(linked.is_linked());
+    ASSERT_FALSE(stereo.is_linked());
+
+    size_t before = esphome::global_preferences->stored_bytes();
+    ASSERT_TRUE(manager.save_profile("Stereo", stereo));
+    size_t stereo_bytes = esphome::global_preferences->stored_bytes() - before;
+
+    before = esphome::global_preferences->stored_bytes();
+    ASSERT_TRUE(manager.save_profile("Linked", linked));
+    size_t linked_bytes = esphome::global_preferences->stored_bytes() - before;
+    ASSERT_TRUE(linked_bytes * 10 < stereo_bytes * 6);
+
+    // Loads back as a full two-channel profile
+    tas5805m_profile::CalibrationProfile loaded;
+    ASSERT_TRUE(manager.load_profile("Linked", loaded));
+    ASSERT_TRUE(loaded.is_valid());
+    ASSERT_TRUE(loaded.is_linked());
+    ASSERT_EQ(strcmp(loaded.name, "Linked"), 0);
+    for (int i = 0; i < 15; i++) {
+        ASSERT_TRUE(same_wire(loaded.left_channel[i].to_coeffs(), left[i]));
+    }
+
+    // Boot apply streams the one-channel image to both channels
+    ASSERT_TRUE(manager.set_active_profile("Linked"));
+    ASSERT_TRUE(manager.load_and_apply_active_profile(&bus, ADDR));
+    for (int i = 0; i < 15; i++) {
+        ASSERT_TRUE(chip_holds(bus, 0, i, left[i]));
+        ASSERT_TRUE(chip_holds(bus, 1, i, left[i]));
+    }
+    ASSERT_TRUE(bus.transactions() <= FULL_APPLY_MAX_TRANSACTIONS);
+
+    // Re-saving as stereo replaces the one-channel record
+    ASSERT_TRUE(manager.save_profile("Linked", stereo));
+    ASSERT_TRUE(manager.load_profile("Linked", loaded));
+    ASSERT_FALSE(loaded.is_linked());
+}
+
+TEST(compact_profile_stores_active_biquads_only) {
+    I2CBus bus;
+    reset_state(bus);
+    esphome::global_preferences->clear();
+
+    tas5805m_profile::ProfileManager manager;
+    manager.setup();
+
+    // Typical correction: a few bands per channel, the rest bypass
+    tas5805m_profile::CalibrationProfile profile;
+    profile.left_channel[0] = calc_highpass(25.0f, 0.7071f);
+    profile.left_channel[1] = calc_parametric_eq(48.0f, -6.0f, 4.0f);
+    profile.left_channel[7] = calc_parametric_eq(210.0f, -3.0f, 2.0f);
+    profile.right_channel[0] = calc_highpass(25.0f, 0.7071f);
+    profile.right_channel[2] = calc_parametric_eq(52.0f, -5.0f, 4.0f);
+    profile.right_channel[14] = calc_high_shelf(8000.0f, -2.0f);
+
+    size_t before = esphome::global_preferences->stored_bytes();
+    ASSERT_TRUE(manager.save_profile("Den", profile));
+    size_t stored = esphome::global_preferences->stored_bytes() - before;
+    ASSERT_TRUE(stored < sizeof(tas5805m_profile::CalibrationProfile) / 2);
+
+    tas5805m_profile::CalibrationProfile loaded;
+    ASSERT_TRUE(manager.load_profile("Den", loaded));
+    ASSERT_TRUE(loaded.is_valid());
+    ASSERT_EQ(loaded.num_filters_used, 5);
+    for (int i = 0; i < 15; i++) {
+        ASSERT_TRUE(same_wire(loaded.left_channel[i].to_coeffs(), profile.left_channel[i].to_coeffs()));
+        ASSERT_TRUE(same_wire(loaded.right_channel[i].to_coeffs(), profile.right_channel[i].to_coeffs()));
+    }
+
+    // Boot apply expands the record straight to the chip
+    ASSERT_TRUE(manager.set_active_profile("Den"));
+    ASSERT_TRUE(manager.load_and_apply_active_profile(&bus, ADDR));
+    for (int i = 0; i < 15; i++) {
+        ASSERT_TRUE(chip_holds(bus, 0, i, profile.left_channel[i].to_coeffs()));
+        ASSERT_TRUE(chip_holds(bus, 1, i, profile.right_channel[i].to_coeffs()));
+    }
+
+    // A fresh boot rebuilds the same directory from the records
+    esphome::global_preferences->make_preference<uint8_t>(nvs_key("profile_dir")).save(&before);
+    tas5805m_profile::ProfileManager rebooted;
+    rebooted.setup();
+    ASSERT_TRUE(rebooted.load_profile("Den", loaded));
+    ASSERT_TRUE(loaded.is_valid());
+}
+
+TEST(legacy_profile_loads_and_migrates) {
+    I2CBus bus;
+    reset_state(bus);
+    esphome::global_preferences->clear();
+
+    // Profile written by older firmware: full float record, no directory
+    tas5805m_profile::LegacyCalibrationProfile legacy;
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+    for (int i = 0; i < 15; i++) {
+        legacy.left_channel[i] = left[i];
+        legacy.right_channel[i] = right[i];
+    }
+    legacy.magic = tas5805m_profile::PROFILE_MAGIC;
+    strncpy(legacy.name, "Old", sizeof(legacy.name) - 1);
+    legacy.num_filters_used = 15;
+    legacy.checksum = legacy.calculate_checksum();
+    esphome::global_preferences->make_preference<tas5805m_profile::LegacyCalibrationProfile>(
+        nvs_key("profile_2")).save(&legacy);
+    int8_t active = 2;
+    esphome::global_preferences->make_preference<int8_t>(nvs_key("active_profile")).save(&active);
+
+    tas5805m_profile::ProfileManager manager;
+    manager.setup();
+    ASSERT_EQ(manager.get_active_profile_name(), std::string("Old"));
+
+    tas5805m_profile::CalibrationProfile loaded;
+    ASSERT_TRUE(manager.load_profile("Old", loaded));
+    ASSERT_TRUE(loaded.is_valid());
+    ASSERT_EQ(memcmp(loaded.left_channel, legacy.left_channel, sizeof(legacy.left_channel)), 0);
+    ASSERT_EQ(memcmp(loaded.right_channel, legacy.right_channel, sizeof(legacy.right_channel)), 0);
+
+    tas5805m_profile::current_profile_shadow() = tas5805m_profile::CalibrationProfile();
+    ASSERT_TRUE(manager.load_and_apply_active_profile(&bus, ADDR));
+    for (int i = 0; i < 15; i++) {
+        ASSERT_TRUE(chip_holds(bus, 0, i, left[i]));
+        ASSERT_TRUE(chip_holds(bus, 1, i, right[i]));
+    }
+    ASSERT_EQ(memcmp(tas5805m_profile::current_profile_shadow().left_channel, legacy.left_channel,
+                     sizeof(legacy.left_channel)), 0);
+
+    // Rewritten in the compact format; the next boot streams the record
+    ASSERT_FALSE(esphome::global_preferences->make_preference<tas5805m_profile::LegacyCalibrationProfile>(
+        nvs_key("profile_2")).load(&legacy));
+    bus.reset_counters();
+    invalidate_coeff_shadow();
+    ASSERT_TRUE(manager.load_and_apply_active_profile(&bus, ADDR));
+    ASSERT_TRUE(bus.transactions() <= FULL_APPLY_MAX_TRANSACTIONS);
+    ASSERT_TRUE(manager.load_profile("Old", loaded));
+    for (int i = 0; i < 15; i++) {
+        ASSERT_TRUE(same_wire(loaded.left_channel[i].to_coeffs(), left[i]));
+    }
+}
+
+// Designed bands on both channels plus one uploaded (RAW) band
+static void make_designed_profile(tas5805m_profile::CalibrationProfile& profile) {
+    using tas5805m_profile::add_filter_to_profile;
+    add_filter_to_profile(profile, 2, 0, FilterDesign(FilterType::HIGHPASS, 25.0f, 0.0f, 0.7071f));
+    add_filter_to_profile(profile, 0, 1, FilterDesign(FilterType::PEAKING, 48.0f, -6.0f, 4.0f));
+    add_filter_to_profile(profile, 1, 1, FilterDesign(FilterType::PEAKING, 52.0f, -5.0f, 4.0f));
+    add_filter_to_profile(profile, 2, 5, FilterDesign(FilterType::LOW_SHELF, 150.0f, 2.0f, 0.7f));
+    add_filter_to_profile(profile, 2, 7, FilterDesign(FilterType::PEAKING, 210.0f, -3.0f, 2.0f));
+    add_filter_to_profile(profile, 1, 14, FilterDesign(FilterType::HIGH_SHELF, 8000.0f, -2.0f, 1.0f));
+    BiquadCoeffs raw = calc_notch(3150.0f, 8.0f);
+    add_filter_to_profile(profile, 0, 9, raw.b0, raw.b1, raw.b2, raw.a1, raw.a2);
+    profile.count_active_filters();
+}
+
+TEST(designed_profile_follows_sample_rate) {
+    I2CBus bus;
+    reset_state(bus);
+    esphome::global_preferences->clear();
+
+    tas5805m_profile::ProfileManager manager;
+    manager.setup();
+
+    tas5805m_profile::CalibrationProfile profile;
+    make_designed_profile(profile);
+
+    // Designs are stored instead of coefficients (13 instead of 20 bytes)
+    tas5805m_profile::CalibrationProfile raw_copy = profile;
+    for (int i = 0; i < 15; i++) {
+        raw_copy.left_design[i] = FilterDesign();
+        raw_copy.right_design[i] = FilterDesign();
+    }
+    size_t before = esphome::global_preferences->stored_bytes();
+    ASSERT_TRUE(manager.save_profile("Raw", raw_copy));
+    size_t raw_bytes = esphome::global_preferences->stored_bytes() - before;
+    before = esphome::global_preferences->stored_bytes();
+    ASSERT_TRUE(manager.save_profile("Den", profile));
+    size_t designed_bytes = esphome::global_preferences->stored_bytes() - before;
+    ASSERT_TRUE(designed_bytes < raw_bytes);
+
+    tas5805m_profile::CalibrationProfile loaded;
+    ASSERT_TRUE(manager.load_profile("Den", loaded));
+    ASSERT_TRUE(loaded.right_design[14].type == FilterType::HIGH_SHELF);
+    ASSERT_TRUE(loaded.left_design[9].type == FilterType::RAW);
+    for (int i = 0; i < 15; i++) {
+        ASSERT_TRUE(same_wire(loaded.left_channel[i].to_coeffs(), profile.left_channel[i].to_coeffs()));
+        ASSERT_TRUE(same_wire(loaded.right_channel[i].to_coeffs(), profile.right_channel[i].to_coeffs()));
+    }
+
+    // Boot at 44.1 kHz: designed bands are recomputed, the RAW band is not
+    ASSERT_TRUE(manager.set_active_profile("Den"));
+    ASSERT_TRUE(manager.load_and_apply_active_profile(&bus, ADDR, 44100.0f));
+    ASSERT_TRUE(chip_holds(bus, 0, 0, calc_highpass(25.0f, 0.7071f, 44100.0f)));
+    ASSERT_TRUE(chip_holds(bus, 1, 0, calc_highpass(25.0f, 0.7071f, 44100.0f)));
+    ASSERT_TRUE(chip_holds(bus, 0, 1, calc_parametric_eq(48.0f, -6.0f, 4.0f, 44100.0f)));
+    ASSERT_TRUE(chip_holds(bus, 1, 5, calc_low_shelf(150.0f, 2.0f, 0.7f, 44100.0f)));
+    ASSERT_TRUE(chip_holds(bus, 1, 14, calc_high_shelf(8000.0f, -2.0f, 1.0f, 44100.0f)));
+    ASSERT_TRUE(chip_holds(bus, 0, 9, calc_notch(3150.0f, 8.0f)));
+    ASSERT_TRUE(chip_holds(bus, 0, 14, BiquadCoeffs()));
+
+    // Back at the reference rate the chip holds the profile as saved
+    ASSERT_TRUE(manager.load_and_apply_active_profile(&bus, ADDR));
+    for (int i = 0; i < 15; i++) {
+        ASSERT_TRUE(chip_holds(bus, 0, i, profile.left_channel[i].to_coeffs()));
+        ASSERT_TRUE(chip_holds(bus, 1, i, profile.right_channel[i].to_coeffs()));
+    }
+}
+
+TEST(designs_survive_trig_cache_churn) {
+    esphome::global_preferences->clear();
+    tas5805m_profile::ProfileManager manager;
+    manager.setup();
+
+    // Designed while 8 kHz sits in its seeded trig slot, saved after other
+    // frequencies evicted it: the design must still reproduce its bytes
+    tas5805m_biquad::g_trig_cache = tas5805m_biquad::TrigCache();
+    tas5805m_profile::CalibrationProfile profile;
+    tas5805m_profile::add_filter_to_profile(profile, 2, 13, FilterDesign(FilterType::PEAKING, 8000.0f, 6.0f, 2.0f));
+    profile.count_active_filters();
+    for (float f = 8001.0f; f <= 8100.0f; f += 1.0f) calc_parametric_eq(f, 1.0f, 1.0f);
+    ASSERT_TRUE(manager.save_profile("Churn", profile));
+
+    tas5805m_profile::CalibrationProfile loaded;
+    ASSERT_TRUE(manager.load_profile("Churn", loaded));
+    ASSERT_TRUE(loaded.right_design[13].type == FilterType::PEAKING);
+    ASSERT_TRUE(same_wire(loaded.right_channel[13].to_coeffs(), profile.right_channel[13].to_coeffs()));
+}
+
+TEST(boot_apply_fills_profile_shadow) {
+    I2CBus bus;
+    reset_state(bus);
+    esphome::global_preferences->clear();
+
+    tas5805m_profile::CalibrationProfile profile;
+    make_designed_profile(profile);
+    {
+        tas5805m_profile::ProfileManager before_reboot;
+        before_reboot.setup();
+        ASSERT_TRUE(before_reboot.save_profile("Den", profile));
+        ASSERT_TRUE(before_reboot.set_active_profile("Den"));
+    }
+
+    // Reboot: empty shadow, the boot stage applies the active profile
+    tas5805m_profile::current_profile_shadow() = tas5805m_profile::CalibrationProfile();
+    tas5805m_profile::ProfileManager manager;
+    manager.setup();
+    ASSERT_TRUE(manager.apply_at_boot(&bus, ADDR));
+
+    tas5805m_profile::CalibrationProfile stored;
+    ASSERT_TRUE(manager.load_profile("Den", stored));
+    const auto& shadow = tas5805m_profile::current_profile_shadow();
+    ASSERT_EQ(shadow.used_slots(), stored.used_slots());
+    ASSERT_TRUE(shadow.used_slots() != 0);
+
+    // The first rate change after boot regenerates the correction, not bypass
+    tas5805m_profile::RateImageCache cache;
+    tas5805m_profile::WireImage expected;
+    memcpy(expected, cache.image_for(stored, 44100.0f), sizeof(expected));
+    const tas5805m_profile::WireImage& image = cache.image_for(shadow, 44100.0f);
+    ASSERT_EQ(memcmp(image, expected, sizeof(expected)), 0);
+    uint8_t shelf[BIQUAD_WIRE_BYTES];
+    pack_biquad(calc_high_shelf(8000.0f, -2.0f, 1.0f, 44100.0f), shelf);
+    ASSERT_EQ(memcmp(&image[1][14 * BIQUAD_WIRE_BYTES], shelf, sizeof(shelf)), 0);
+}
+
+TEST(rate_image_cache_reuses_images) {
+    tas5805m_profile::CalibrationProfile profile;
+    make_designed_profile(profile);
+    tas5805m_profile::RateImageCache cache;
+
+    int locked = -1;
+    const tas5805m_profile::WireImage& at_96k = cache.image_for(profile, 96000.0f, &locked);
+    ASSERT_EQ(locked, 1);  // The RAW notch
+    uint8_t expected[BIQUAD_WIRE_BYTES];
+    pack_biquad(calc_parametric_eq(52.0f, -5.0f, 4.0f, 96000.0f), expected);
+    ASSERT_EQ(memcmp(&at_96k[1][1 * BIQUAD_WIRE_BYTES], expected, sizeof(expected)), 0);
+    pack_biquad(calc_notch(3150.0f, 8.0f), expected);
+    ASSERT_EQ(memcmp(&at_96k[0][9 * BIQUAD_WIRE_BYTES], expected, sizeof(expected)), 0);
+
+    cache.image_for(profile, 44100.0f);
+    cache.image_for(profile, 96000.0f);
+    cache.image_for(profile, 48000.0f, &locked);
+    ASSERT_EQ(locked, 0);
+    ASSERT_EQ(cache.misses(), 3u);
+    ASSERT_EQ(cache.hits(), 1u);
+
+    // Three rates fit; an edited profile misses instead of replaying old bytes
+    cache.image_for(profile, 44100.0f);
+    ASSERT_EQ(cache.hits(), 2u);
+    tas5805m_profile::add_filter_to_profile(profile, 0, 3, FilterDesign(FilterType::PEAKING, 90.0f, -3.0f, 2.0f));
+    const tas5805m_profile::WireImage& edited = cache.image_for(profile, 44100.0f);
+    ASSERT_EQ(cache.misses(), 4u);
+    pack_biquad(calc_parametric_eq(90.0f, -3.0f, 2.0f, 44100.0f), expected);
+    ASSERT_EQ(memcmp(&edited[0][3 * BIQUAD_WIRE_BYTES], expected, sizeof(expected)), 0);
+}
+
+TEST(optimized_profile_keeps_designs) {
+    tas5805m_profile::CalibrationProfile profile;
+    using tas5805m_profile::add_filter_to_profile;
+    add_filter_to_profile(profile, 2, 3, FilterDesign(FilterType::HIGHPASS, 25.0f, 0.0f, 0.7071f));
+    add_filter_to_profile(profile, 2, 8, FilterDesign(FilterType::PEAKING, 100.0f, -3.0f, 2.0f));
+    add_filter_to_profile(profile, 2, 9, FilterDesign(FilterType::PEAKING, 104.0f, -2.0f, 2.0f));
+
+    tas5805m_profile::optimize_profile(profile);
+
+    // Packed to the front: the highpass keeps its design, the merged PEQ gets one
+    ASSERT_TRUE(profile.left_design[0].type == FilterType::HIGHPASS);
+    ASSERT_TRUE(profile.left_design[1].type == FilterType::PEAKING);
+    ASSERT_TRUE(profile.left_channel[2].is_bypass());
+    BiquadCoeffs redesigned;
+    ASSERT_TRUE(calc_filter(profile.left_design[1], 48000.0f, redesigned));
+    ASSERT_TRUE(same_wire(redesigned, profile.left_channel[1].to_coeffs()));
+}
+
+TEST(upload_builds_profile_in_one_pass) {
+    using tas5805m_profile::profile_from_upload;
+    // Peaking, bypass, highpass; no right array: stereo-linked
+    std::vector<float> left = {1, 100.0f, -3.0f, 2.0f,  0, 0, 0, 0,  4, 25.0f, 0, 0.7071f};
+    tas5805m_profile::CalibrationProfile profile;
+    ASSERT_TRUE(profile_from_upload(left, {}, 48000.0f, profile));
+    ASSERT_TRUE(profile.is_linked());
+    ASSERT_EQ(profile.num_filters_used, 2);
+    ASSERT_TRUE(profile.left_channel[1].is_bypass());
+    ASSERT_TRUE(same_wire(profile.right_channel[0].to_coeffs(), calc_parametric_eq(100.0f, -3.0f, 2.0f)));
+    ASSERT_TRUE(profile.left_design[2].type == FilterType::HIGHPASS);
+
+    std::vector<float> right = {6, 3150.0f, 0, 8.0f};
+    ASSERT_TRUE(profile_from_upload(left, right, 48000.0f, profile));
+    ASSERT_FALSE(profile.is_linked());
+    ASSERT_TRUE(profile.right_channel[2].is_bypass());
+    ASSERT_TRUE(profile.right_design[0].type == FilterType::NOTCH);
+
+    // Any bad entry rejects the whole upload and leaves the profile as it was
+    tas5805m_profile::CalibrationProfile before = profile;
+    const std::vector<float> bad[] = {
+        {1, 100.0f, -3.0f},                       // Not a whole slot
+        {7, 100.0f, -3.0f, 2.0f},                 // Unknown type
+        {-1, 100.0f, -3.0f, 2.0f},
+        {1.5f, 100.0f, -3.0f, 2.0f},
+        {NAN, 100.0f, -3.0f, 2.0f},
+        {1, 100.0f, -30.0f, 2.0f},                // Gain out of range
+        {2, 100.0f, 3.0f, 9.0f},                  // Shelf slope out of range
+        {1, 20000.0f, -3.0f, 2.0f},               // Above Nyquist at 32 kHz
+        std::vector<float>(16 * 4, 0.0f),         // More than 15 slots
+    };
+    for (const auto& values : bad) {
+        ASSERT_FALSE(profile_from_upload(left, values, 32000.0f, profile));
+    }
+    ASSERT_EQ(memcmp(&profile, &before, sizeof(profile)), 0);
+}
+
+TEST(dozens_of_profiles_fit) {
+    esphome::global_preferences->clear();
+
+    tas5805m_profile::ProfileManager manager;
+    manager.setup();
+
+    tas5805m_profile::CalibrationProfile profile;
+    for (int i = 0; i < 6; i++) {
+        profile.left_channel[i] = calc_parametric_eq(60.0f * (i + 1), -3.0f, 3.0f);
+        profile.right_channel[i] = profile.left_channel[i];
+    }
+
+    size_t before = esphome::global_preferences->stored_bytes();
+    for (size_t n = 0; n < tas5805m_profile::MAX_PROFILES; n++) {
+        char name[16];
+        snprintf(name, sizeof(name), "Room %u", (unsigned)n);
+        ASSERT_TRUE(manager.save_profile(name, profile));
+    }
+    ASSERT_FALSE(manager.save_profile("One too many", profile));
+    ASSERT_EQ(manager.list_profiles().size(), tas5805m_profile::MAX_PROFILES);
+
+    // Six linked bands: ~210 bytes per profile
+    size_t used = esphome::global_preferences->stored_bytes() - before;
+    ASSERT_TRUE(used < tas5805m_profile::MAX_PROFILES * 256);
+}
+
+TEST(profile_changes_commit_once_and_skip_unchanged) {
+    esphome::global_preferences->clear();
+    auto& nvs = esphome::global_preferences->counters;
+
+    tas5805m_profile::ProfileManager manager;
+    manager.setup();
+
+    tas5805m_profile::CalibrationProfile profile;
+    profile.left_channel[0] = calc_parametric_eq(80.0f, -4.0f, 3.0f);
+    profile.right_channel[0] = profile.left_channel[0];
+
+    // Record + directory in one commit
+    nvs = esphome::PreferenceCounters();
+    ASSERT_TRUE(manager.save_profile("Office", profile));
+    ASSERT_EQ(nvs.saves, 2u);
+    ASSERT_EQ(nvs.syncs, 1u);
+
+    // Re-saving the same filters touches nothing
+    nvs = esphome::PreferenceCounters();
+    ASSERT_TRUE(manager.save_profile("Office", profile));
+    ASSERT_EQ(nvs.saves, 0u);
+    ASSERT_EQ(nvs.syncs, 0u);
+
+    // Neither does re-selecting the active profile
+    ASSERT_TRUE(manager.set_active_profile("Office"));
+    nvs = esphome::PreferenceCounters();
+    ASSERT_TRUE(manager.set_active_profile("Office"));
+    ASSERT_EQ(nvs.saves, 0u);
+    ASSERT_EQ(nvs.syncs, 0u);
+
+    // A real edit rewrites the record and directory
+    profile.left_channel[1] = calc_parametric_eq(300.0f, 2.0f, 1.0f);
+    nvs = esphome::PreferenceCounters();
+    ASSERT_TRUE(manager.save_profile("Office", profile));
+    ASSERT_EQ(nvs.saves, 2u);
+    ASSERT_EQ(nvs.syncs, 1u);
+
+    // Deleting the active profile: directory + active index, one commit,
+    // no record rewrite
+    size_t stored = esphome::global_preferences->stored_bytes();
+    nvs = esphome::PreferenceCounters();
+    ASSERT_TRUE(manager.delete_profile("Office"));
+    ASSERT_EQ(nvs.saves, 2u);
+    ASSERT_EQ(nvs.syncs, 1u);
+    ASSERT_EQ(esphome::global_preferences->stored_bytes(), stored);
+
+    tas5805m_profile::CalibrationProfile loaded;
+    ASSERT_FALSE(manager.load_profile("Office", loaded));
+    ASSERT_TRUE(manager.list_profiles().empty());
+    ASSERT_EQ(manager.get_active_profile_name(), std::string("none"));
+
+    // The slot is reusable
+    ASSERT_TRUE(manager.save_profile("Kitchen", profile));
+    ASSERT_TRUE(manager.load_profile("Kitchen", loaded));
+}
+
+TEST(optimized_profile_touches_fewer_pages) {
+    I2CBus bus;
+    reset_state(bus);
+    ASSERT_TRUE(reset_all_biquads_batched(&bus, ADDR));
+
+    // Bands spread over every page, two of them overlapping, one inaudible
+    tas5805m_profile::CalibrationProfile profile;
+    profile.left_channel[0] = calc_parametric_eq(100.0f, -3.0f, 2.0f);
+    profile.left_channel[4] = calc_parametric_eq(106.0f, -3.0f, 2.0f);
+    profile.left_channel[8] = calc_parametric_eq(2000.0f, 0.1f, 2.0f);
+    profile.left_channel[12] = calc_parametric_eq(5000.0f, -4.0f, 3.0f);
+    tas5805m_profile::CalibrationProfile optimized = profile;
+    ASSERT_EQ(tas5805m_profile::optimize_profile(optimized), 2);
+    ASSERT_TRUE(optimized.is_valid());
+
+    BiquadCoeffs left[15], right[15];
+    for (int i = 0; i < 15; i++) {
+        left[i] = optimized.left_channel[i].to_coeffs();
+        right[i] = optimized.right_channel[i].to_coeffs();
+    }
+    bus.reset_counters();
+    ASSERT_TRUE(write_all_biquads_delta(&bus, ADDR, left, right));
+    ASSERT_EQ(coeff_pages_written(bus).size(), 1u);
+
+    // The unoptimized profile needs all four left pages
+    for (int i = 0; i < 15; i++) left[i] = profile.left_channel[i].to_coeffs();
+    bus.reset_counters();
+    ASSERT_TRUE(write_all_biquads_delta(&bus, ADDR, left, right));
+    ASSERT_EQ(coeff_pages_written(bus).size(), 4u);
+}
+
+// =============================================================================
+// COEFFICIENT WRITER
+// =============================================================================
+
+TEST(writer_runs_on_loop_and_returns_to_book0) {
+    I2CBus bus;
+    reset_state(bus);
+
+    tas5805m_writer::CoeffWriter writer;
+    writer.start(&bus, ADDR);
+
+    // Queued, not written: the bus stays free for the driver until loop()
+    BiquadCoeffs first = calc_parametric_eq(100.0f, -3.0f, 2.0f);
+    BiquadCoeffs last = calc_parametric_eq(120.0f, -4.0f, 2.0f);
+    ASSERT_TRUE(writer.write_biquad(2, 3, first) != 0);
+    ASSERT_TRUE(writer.write_biquad(2, 3, last) != 0);
+    ASSERT_EQ(writer.pending(), 1u);
+    writer.loop();
+    ASSERT_EQ(bus.transactions(), 0u);
+
+    // One flush once the window expires, newest value only
+    esphome::delay(tas5805m_writer::COALESCE_WINDOW_MS);
+    writer.loop();
+    ASSERT_EQ(writer.pending(), 0u);
+    ASSERT_TRUE(chip_holds(bus, 0, 3, last));
+    ASSERT_TRUE(chip_holds(bus, 1, 3, last));
+    ASSERT_EQ(writer.stats().coalesced.load(), 2u);
+    ASSERT_TRUE(chip_at_book0(bus));
+
+    // A pinned slot survives a full apply; its pending flush goes stale
+    uint8_t pinned[BIQUAD_WIRE_BYTES];
+    pack_biquad(calc_high_shelf(10000.0f, 3.0f), pinned);
+    ASSERT_TRUE(writer.pin_biquad(2, 14, pinned) != 0);
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+    ASSERT_TRUE(writer.apply_profile(left, right) != 0);
+    ASSERT_EQ(writer.pending(), 2u);
+
+    bus.reset_counters();
+    writer.loop();
+    ASSERT_EQ(bus.transactions(), 0u);
+    writer.loop();
+    ASSERT_EQ(writer.pending(), 0u);
+    ASSERT_TRUE(writer.stats().last_ok.load());
+    for (int i = 0; i < 14; i++) {
+        ASSERT_TRUE(chip_holds(bus, 0, i, left[i]));
+        ASSERT_TRUE(chip_holds(bus, 1, i, right[i]));
+    }
+    ASSERT_TRUE(chip_holds(bus, 0, 14, unpack_biquad(pinned)));
+    ASSERT_TRUE(chip_holds(bus, 1, 14, unpack_biquad(pinned)));
+    ASSERT_TRUE(chip_at_book0(bus));
+    ASSERT_EQ(bus.peek(0x00, 0x00, REG_DEVICE_CTRL2) & DEVICE_CTRL2_MUTE, 0);
+
+    // So does a single-slot reset (reset_biquad); the unpinned channel of
+    // a right-only pin takes the bypass
+    uint8_t right_pin[BIQUAD_WIRE_BYTES];
+    pack_biquad(calc_low_shelf(100.0f, 4.0f), right_pin);
+    ASSERT_TRUE(writer.pin_biquad(1, 13, right_pin) != 0);
+    ASSERT_TRUE(writer.write_biquad(2, 14, BiquadCoeffs()) != 0);
+    ASSERT_TRUE(writer.write_biquad(2, 13, BiquadCoeffs()) != 0);
+    esphome::delay(tas5805m_writer::COALESCE_WINDOW_MS);
+    writer.loop();
+    ASSERT_EQ(writer.pending(), 0u);
+    ASSERT_TRUE(chip_holds(bus, 0, 14, unpack_biquad(pinned)));
+    ASSERT_TRUE(chip_holds(bus, 1, 14, unpack_biquad(pinned)));
+    ASSERT_TRUE(chip_holds(bus, 0, 13, BiquadCoeffs()));
+    ASSERT_TRUE(chip_holds(bus, 1, 13, unpack_biquad(right_pin)));
+    writer.unpin_biquad(1, 13);
+
+    // Unpinned, the next apply writes the profile's own filter
+    writer.unpin_biquad(2, 14);
+    writer.apply_profile(left, right);
+    writer.loop();
+    ASSERT_TRUE(chip_holds(bus, 0, 14, left[14]));
+    ASSERT_TRUE(chip_holds(bus, 1, 14, right[14]));
+    ASSERT_TRUE(chip_at_book0(bus));
+}
+
+TEST(scheduled_apply_keeps_its_image_and_lets_flushes_pass) {
+    I2CBus bus;
+    reset_state(bus);
+
+    tas5805m_writer::CoeffWriter writer;
+    writer.start(&bus, ADDR);
+
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+    uint8_t scheduled[2][15 * BIQUAD_WIRE_BYTES];
+    pack_channels(left, right, scheduled);
+    uint8_t later[2][15 * BIQUAD_WIRE_BYTES];
+    BiquadCoeffs bypass[15];
+    pack_channels(bypass, bypass, later);
+
+    // Commit time just past the spin window, so the first passes hold it
+    const int64_t lead_ms = tas5805m_writer::COMMIT_SPIN_US / 1000 + 40;
+    ASSERT_TRUE(writer.apply_wire_at(scheduled, tas5805m_writer::epoch_ms() + lead_ms) != 0);
+    uint64_t due_us = tas5805m_perf::now_us() + static_cast<uint64_t>(lead_ms) * 1000;
+
+    // A slider move behind it is written right away and kept by the commit
+    BiquadCoeffs moved = calc_parametric_eq(250.0f, 2.0f, 1.0f);
+    ASSERT_TRUE(writer.write_biquad(0, 4, moved) != 0);
+    esphome::delay(tas5805m_writer::COALESCE_WINDOW_MS);
+    writer.loop();
+    ASSERT_EQ(writer.pending(), 1u);
+    ASSERT_TRUE(chip_holds(bus, 0, 4, moved));
+
+    // A later apply does not overwrite the image staged for the commit
+    ASSERT_TRUE(writer.apply_wire(later) != 0);
+    ASSERT_EQ(writer.pending(), 2u);
+    while (tas5805m_perf::now_us() + tas5805m_writer::COMMIT_SPIN_US < due_us) {
+    }
+    writer.loop();
+    ASSERT_EQ(writer.pending(), 1u);
+    ASSERT_EQ(writer.stats().scheduled.load(), 1u);
+    ASSERT_TRUE(chip_holds(bus, 0, 4, moved));
+    ASSERT_TRUE(chip_holds(bus, 1, 4, right[4]));
+    ASSERT_TRUE(chip_holds(bus, 0, 7, left[7]));
+    ASSERT_TRUE(chip_holds(bus, 1, 7, right[7]));
+
+    writer.loop();
+    ASSERT_EQ(writer.pending(), 0u);
+    for (int i = 0; i < 15; i++) {
+        ASSERT_TRUE(chip_holds(bus, 0, i, BiquadCoeffs()));
+        ASSERT_TRUE(chip_holds(bus, 1, i, BiquadCoeffs()));
+    }
+    ASSERT_TRUE(chip_at_book0(bus));
+}
+
+TEST(loudness_avoids_boot_profile_slots) {
+    I2CBus bus;
+    reset_state(bus);
+    esphome::global_preferences->clear();
+
+    // Active profile with corrections in the default shelf slots 13 and 14
+    tas5805m_profile::CalibrationProfile profile;
+    tas5805m_profile::add_filter_to_profile(profile, 2, 13, FilterDesign(FilterType::PEAKING, 60.0f, -4.0f, 3.0f));
+    tas5805m_profile::add_filter_to_profile(profile, 2, 14, FilterDesign(FilterType::HIGH_SHELF, 9000.0f, -2.0f, 1.0f));
+    profile.count_active_filters();
+    {
+        tas5805m_profile::ProfileManager before_reboot;
+        before_reboot.setup();
+        ASSERT_TRUE(before_reboot.save_profile("Top", profile));
+        ASSERT_TRUE(before_reboot.set_active_profile("Top"));
+    }
+
+    // Reboot, boot apply, then set_loudness
+    tas5805m_profile::current_profile_shadow() = tas5805m_profile::CalibrationProfile();
+    tas5805m_profile::ProfileManager manager;
+    manager.setup();
+    ASSERT_TRUE(manager.apply_at_boot(&bus, ADDR));
+    tas5805m_writer::CoeffWriter writer;
+    writer.start(&bus, ADDR);
+
+    tas5805m_loudness::LoudnessCache loudness;
+    uint16_t released = 0;
+    ASSERT_TRUE(loudness.build(tas5805m_loudness::LoudnessSettings(), 48000.0f));
+    ASSERT_TRUE(loudness.fit(writer, tas5805m_profile::current_profile_shadow().used_slots(), released));
+    ASSERT_EQ(loudness.bass_slot(), 11);
+    ASSERT_EQ(loudness.treble_slot(), 12);
+    ASSERT_TRUE(loudness.follow(writer, 0.0f) != 0);
+    esphome::delay(tas5805m_writer::COALESCE_WINDOW_MS);
+    writer.loop();
+    ASSERT_EQ(writer.pending(), 0u);
+
+    // The correction stays, the shelves sit next to it
+    tas5805m_profile::CalibrationProfile stored;
+    ASSERT_TRUE(manager.load_profile("Top", stored));
+    for (int ch = 0; ch < 2; ch++) {
+        const auto* coeffs = ch == 0 ? stored.left_channel : stored.right_channel;
+        ASSERT_TRUE(chip_holds(bus, ch, 13, coeffs[13].to_coeffs()));
+        ASSERT_TRUE(chip_holds(bus, ch, 14, coeffs[14].to_coeffs()));
+        ASSERT_TRUE(chip_holds(bus, ch, 11, unpack_biquad(loudness.wire(loudness.current(), 0))));
+        ASSERT_TRUE(chip_holds(bus, ch, 12, unpack_biquad(loudness.wire(loudness.current(), 1))));
+    }
+    ASSERT_TRUE(chip_at_book0(bus));
+}
+
+// =============================================================================
+// INSTRUMENTATION
+// =============================================================================
+
+TEST(perf_histogram_percentiles) {
+    tas5805m_perf::Histogram h;
+    for (uint32_t us = 1; us <= 1000; us++) h.record(us, true);
+    h.record(5000, false);
+
+    ASSERT_EQ(h.count, 1001u);
+    ASSERT_EQ(h.failures, 1u);
+    ASSERT_EQ(h.min_us, 1u);
+    ASSERT_EQ(h.max_us, 5000u);
+    ASSERT_EQ(h.avg_us(), (500500u + 5000u) / 1001u);
+
+    // Bucket upper bound: at most 25% above the exact p99 (991 us)
+    ASSERT_TRUE(h.p99_us() >= 991u && h.p99_us() <= 991u * 5 / 4);
+    ASSERT_EQ(h.percentile_us(100), 5000u);
+}
+
+TEST(perf_buckets_are_contiguous) {
+    for (size_t b = 1; b < tas5805m_perf::HISTOGRAM_BUCKETS; b++) {
+        uint32_t floor = tas5805m_perf::bucket_floor(b);
+        ASSERT_EQ(tas5805m_perf::bucket_for(floor), b);
+        ASSERT_EQ(tas5805m_perf::bucket_for(floor - 1), b - 1);
+    }
+}
+
+TEST(perf_probes_count_writes_and_retries) {
+    I2CBus bus;
+    reset_state(bus);
+    tas5805m_perf::perf_stats().reset();
+
+    bus.fail_next = 1;
+    ASSERT_TRUE(write_coeffs(&bus, ADDR, 0, 0, calc_highpass(40.0f, 0.7071f), nullptr));
+
+    auto& perf = tas5805m_perf::perf_stats();
+    ASSERT_EQ(perf.i2c().retries, 1u);
+    ASSERT_EQ(perf.i2c().failures, 0u);
+    ASSERT_EQ(perf.snapshot(tas5805m_perf::Probe::WRITE_BYTES).count, 1u);
+    // Into the coefficient page and back to book 0
+    ASSERT_EQ(perf.snapshot(tas5805m_perf::Probe::SELECT_BOOK_PAGE).count, 2u);
+
+    BiquadCoeffs left[15], right[15];
+    make_profile(left, right);
+    ASSERT_TRUE(write_all_biquads_batched(&bus, ADDR, left, right));
+    ASSERT_EQ(perf.snapshot(tas5805m_perf::Probe::WRITE_ALL).count, 1u);
+    ASSERT_EQ(perf.snapshot(tas5805m_perf::Probe::WRITE_ALL).failures, 0u);
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main() {
+    printf("\n=== TAS5805M I2C Tests ===\n\n");
+
+    // Static initialization runs all tests
+
+    printf("\n=== Results ===\n");
+    printf("Tests run: %d\n", tests_run);
+    printf("Passed:    %d\n", tests_passed);
+    printf("Failed:    %d\n", tests_failed);
+
+    return tests_failed > 0 ? 1 : 0;
+}